@@ -0,0 +1,45 @@
+#!/usr/bin/env bash
+# Times 'vcs merge-base' on a deep synthetic history: a line of DEPTH commits, then two branches of WIDTH commits
+# each on top of it. The merge base is the tip of the line, found with the commit-graph and again without it, when
+# every commit is parsed from its object.
+# usage: bench/merge-base.sh [path-to-vcs] [depth] [width]
+set -e
+
+VCS=$(realpath "${1:-test/main.out}")
+DEPTH=${2:-2000}
+WIDTH=${3:-50}
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR"
+export USER=${USER:-bench}
+
+commit_lines() {
+    for ((i = 0; i < $2; i++)); do
+        echo "$1 $i" >> file
+        $VCS add . >/dev/null
+        $VCS commit "$1 $i" >/dev/null
+    done
+}
+
+$VCS init >/dev/null
+echo "Building a history of $DEPTH commits..."
+commit_lines base "$DEPTH"
+base_hash=$(cat .vcs/refs/heads/master)
+
+$VCS branch side >/dev/null
+commit_lines ours "$WIDTH"
+echo Y | $VCS checkout side >/dev/null
+commit_lines theirs "$WIDTH"
+
+run() {
+    local start end
+    start=$(date +%s%N)
+    result=$($VCS merge-base master side | grep -o '[0-9a-f]\{40\}')
+    end=$(date +%s%N)
+    [ "$result" = "$base_hash" ] || { echo "FAIL: merge-base is '$result', expected $base_hash"; exit 1; }
+    echo "$1: $(( (end - start) / 1000000 )) ms"
+}
+
+run "merge-base with commit-graph"
+rm -f .vcs/commit-graph .vcs/commit-graph-bloom
+run "merge-base without commit-graph"
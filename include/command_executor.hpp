@@ -16,9 +16,18 @@
 #include "commands/branch.hpp"
 #include "commands/checkout.hpp"
 #include "commands/merge.hpp"
+#include "commands/merge-base.hpp"
 #include "commands/reset.hpp"
 #include "commands/revert.hpp"
 #include "commands/stash.hpp"
+#include "commands/gc.hpp"
+#include "commands/count-objects.hpp"
+#include "commands/blame.hpp"
+#include "commands/sparse-checkout.hpp"
+#include "commands/worktree.hpp"
+#include "commands/clone.hpp"
+#include "commands/fetch.hpp"
+#include "commands/bundle.hpp"
 
 class CommandExecutor {
 public:
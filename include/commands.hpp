@@ -18,9 +18,18 @@ enum class CommandType {
     BRANCH,
     CHECKOUT,
     MERGE,
+    MERGE_BASE,
     RESET,
     REVERT,
     STASH,
+    GC,
+    COUNT_OBJECTS,
+    BLAME,
+    SPARSE_CHECKOUT,
+    WORKTREE,
+    CLONE,
+    FETCH,
+    BUNDLE,
     UNKNOWN
 };
 
@@ -5,6 +5,7 @@
 #include "commands/hash-object.hpp"
 #include "utils.hpp"
 #include "config.hpp"
+#include "sparse_checkout.hpp"
 #include <filesystem>
 #include <fstream>
 #include <unordered_map>
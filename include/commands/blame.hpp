@@ -0,0 +1,44 @@
+#ifndef BLAME_HPP
+#define BLAME_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "commit_graph.hpp"
+#include "diff_engine.hpp"
+#include <unordered_map>
+#include <queue>
+
+// Lines of the file at one commit whose origin isn't known yet: {line in this commit's blob, line in the final file}
+struct BlameSuspect {
+    std::string blob_hash;
+    std::vector<std::pair<int, int>> lines;
+};
+
+struct BlameAuthor {
+    std::string username;
+    std::time_t timestamp;
+    std::string summary;    // first line of the message
+};
+
+class BlameCommand : public Command {
+private:
+    std::string path;
+    bool is_incremental = false;    // print lines as soon as their commit is known, in the order they're found
+
+    std::unordered_map<std::string, std::vector<std::string>> blob_lines;    // by blob hash
+    std::unordered_map<std::string, BlameAuthor> authors;                      // by commit hash
+
+    const std::vector<std::string>& get_blob_lines(const std::string& blob_hash);
+    const BlameAuthor& get_author(const std::string& commit_hash);
+
+    // Prints runs of consecutive final lines in the incremental format: <commit> <orig-line> <final-line> <count>
+    void print_incremental(const std::string& commit_hash, std::vector<std::pair<int, int>> lines);
+
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+};
+
+#endif // BLAME_HPP
@@ -0,0 +1,37 @@
+#ifndef BUNDLE_HPP
+#define BUNDLE_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "pack.hpp"
+#include "commands/cat-file.hpp"
+#include "commands/fetch.hpp"
+#include <map>
+
+// A bundle carries branches from one repository to another as a single file:
+//   "# v1 vcs bundle"
+//   "-<commit-hash>"            once for every commit the receiver must already have (prerequisite)
+//   "<commit-hash> <branch>"    once for every branch
+//   ""
+//   pack of the objects the branches need on top of the prerequisites
+class BundleCommand : public Command {
+private:
+    std::string subcommand;
+    std::string bundle_path;
+    std::map<std::string, std::string> heads;    // {branch, commit hash} to bundle
+    std::vector<std::string> prerequisite_hashes;
+
+    // The file is written front to back in one pass, the objects are copied from .vcs/objects/ straight into it
+    void create_bundle();
+
+    // Reads the file front to back, one object at a time, into .vcs/objects/ and the branches into .vcs/refs/remotes/<bundle name>/
+    void unbundle();
+
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+};
+
+#endif // BUNDLE_HPP
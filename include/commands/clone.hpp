@@ -0,0 +1,32 @@
+#ifndef CLONE_HPP
+#define CLONE_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "commands/fetch.hpp"
+#include <filesystem>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+class CloneCommand : public Command {
+private:
+    bool is_no_hardlinks = false;
+    std::string source_path;
+    std::string target_path;
+
+    // Same filesystem: every loose object of the source is hard linked instead of copied, and the source's
+    // alternates are listed so borrowed objects stay in reach. Returns how many objects were linked.
+    std::size_t link_objects(const fs::path& source_objects_dir);
+
+    // Branches with their reflogs and HEAD as the source has them
+    void copy_refs(const fs::path& source_dir, const std::map<std::string, std::string>& source_heads, const std::string& source_head);
+
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+};
+
+#endif // CLONE_HPP
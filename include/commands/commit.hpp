@@ -7,12 +7,15 @@
 #include "commands/status.hpp"
 #include "utils.hpp"
 #include "config.hpp"
+#include "commit_graph.hpp"
+#include "sparse_checkout.hpp"
 #include <sstream>
 #include <fstream>
 
 class CommitCommand : public Command {
 public:
     void help() override;
+    static std::string create_commit(const std::string& commit_message);
     void execute(std::vector<std::string>& args) override;
     void validate(std::vector<std::string>& args) override;
 };
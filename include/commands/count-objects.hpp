@@ -0,0 +1,16 @@
+#ifndef COUNT_OBJECTS_HPP
+#define COUNT_OBJECTS_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "reachability.hpp"
+
+class CountObjectsCommand : public Command {
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+};
+
+#endif // COUNT_OBJECTS_HPP
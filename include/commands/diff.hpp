@@ -4,9 +4,37 @@
 #include "commands.hpp"
 #include "utils.hpp"
 #include "commands/cat-file.hpp"
+#include "models/index.hpp"
+#include "diff_engine.hpp"
+#include "sparse_checkout.hpp"
+#include "thread_pool.hpp"
 #include <map>
 
+enum class DiffFormat {
+    PATCH,
+    STAT,
+    NAME_ONLY,
+    NAME_STATUS
+};
+
+struct DiffEntry {
+    char status; // 'A' added, 'M' modified, 'D' deleted, 'R' renamed, 'C' copied
+    std::string filepath;
+    std::string old_mode;
+    std::string old_hash;
+    std::string new_mode;
+    std::string new_hash; // empty when the working directory file was never hashed
+    std::string old_filepath = ""; // source of a rename or copy
+    int similarity = 0;
+};
+
 class DiffCommand : public Command {
+private:
+    DiffFormat format = DiffFormat::PATCH;
+    bool word_diff = false;
+
+    void print_summary(const std::vector<DiffEntry>& entries, bool is_worktree);
+
 public:
     void help() override;
     void commit1_and_commit2_diff(const std::string commit_hash1, const std::string commit_hash2);
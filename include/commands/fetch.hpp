@@ -0,0 +1,40 @@
+#ifndef FETCH_HPP
+#define FETCH_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "pack.hpp"
+#include <filesystem>
+#include <map>
+
+namespace fs = std::filesystem;
+
+class FetchCommand : public Command {
+private:
+    std::string source_path;
+
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+
+    // {branch, commit hash} of the repository at 'repo_path', branches without commits included
+    static std::map<std::string, std::string> read_branch_heads(const std::string& repo_path);
+
+    // Negotiates with the repository at 'source_path' and streams the objects it has for 'want_hashes' and this one
+    // lacks into .vcs/objects/. Returns how many objects were new.
+    static std::size_t fetch_objects(const std::string& source_path, const std::vector<std::string>& want_hashes, const std::vector<std::string>& have_hashes);
+
+    // Name the branches of a repository or bundle are stored under: the last component of its path, without extension
+    static std::string get_remote_name(const fs::path& source_path);
+
+    // {<remote>/<branch>, commit hash} of the branches fetched so far, from .vcs/refs/remotes/
+    static std::map<std::string, std::string> read_remote_heads();
+
+    // Fetched branches land in .vcs/refs/remotes/<remote>/<branch>, so two sources with a branch of the same name
+    // don't overwrite each other. Local branches are left alone. Prints what changed.
+    static void store_remote_heads(const std::string& remote, const std::map<std::string, std::string>& heads);
+};
+
+#endif // FETCH_HPP
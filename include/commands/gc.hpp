@@ -0,0 +1,23 @@
+#ifndef GC_HPP
+#define GC_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "commit_graph.hpp"
+#include "reachability.hpp"
+
+class GcCommand : public Command {
+private:
+    bool is_prune_now = false;
+
+    // Branch heads and every BITMAP_COMMIT_INTERVAL-th commit down their first parents
+    std::vector<std::string> select_bitmap_commits(const std::vector<std::string>& head_hashes);
+
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+};
+
+#endif // GC_HPP
@@ -5,7 +5,13 @@
 #include "utils.hpp"
 #include "config.hpp"
 #include "exceptions/vcs-exception.hpp"
+#include "commit_graph.hpp"
+#include "diff_engine.hpp"
 #include <unordered_map>
+#include <iomanip>
+#include <unordered_set>
+#include <queue>
+#include <tuple>
 
 struct Commit {
     std::string parent_hash;
@@ -15,7 +21,50 @@ struct Commit {
     std::string message;
 };
 
+// Commits of several branches in topological order, the newest first among those whose children were all shown.
+// In-degrees are only counted down to the generation of the commits about to be shown, so the first commits come
+// out without walking the whole history.
+class TopoWalk {
+private:
+    CommitGraph& graph;
+    std::priority_queue<std::pair<uint32_t, std::string>> walk_queue;                    // by generation
+    std::priority_queue<std::tuple<std::time_t, uint32_t, std::string>> ready_queue;   // by commit time
+    std::unordered_map<std::string, int> indegree; // children walked but not shown yet
+    std::unordered_set<std::string> seen, shown;
+
+    // Counts in-degrees from every commit whose generation is above 'generation'
+    void walk_to(uint32_t generation);
+
+public:
+    TopoWalk(CommitGraph& graph, const std::vector<std::string>& start_hashes);
+
+    // False when every commit was shown
+    bool next(std::string& commit_hash);
+};
+
+// Lanes of 'log --graph', each lane waits for one commit. A commit takes the first lane waiting for it and hands
+// it to its first parent, further parents get lanes of their own.
+class GraphRenderer {
+private:
+    std::vector<std::string> lanes;
+
+    // Lines moving every lane from its current column to its new one, one column per line
+    static void draw_shift(std::vector<std::pair<int, int>> edges, std::vector<std::string>& lines);
+
+public:
+    // Lanes in front of the commit's own line, and the lines joining and splitting lanes before and after it
+    void add_commit(const std::string& commit_hash, const std::vector<std::string>& parents, std::string& prefix, std::vector<std::string>& lines_before, std::vector<std::string>& lines_after);
+};
+
 class LogCommand : public Command {
+private:
+    std::string path;        // limits the log to commits that changed it, empty for the whole history
+    int max_count = -1;      // -1 for no limit
+    std::time_t since = 0;   // commits older than this end the walk
+    bool is_oneline = false;
+    bool is_all = false;     // every branch instead of HEAD only
+    bool is_graph = false;
+
 public:
     void help() override;
     void execute(std::vector<std::string>& args) override;
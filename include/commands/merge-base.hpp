@@ -0,0 +1,22 @@
+#ifndef MERGE_BASE_HPP
+#define MERGE_BASE_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "commit_graph.hpp"
+#include "commands/cat-file.hpp"
+
+class MergeBaseCommand : public Command {
+private:
+    bool is_all = false;
+
+    std::string get_commit_hash(const std::string& name);
+
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+};
+
+#endif // MERGE_BASE_HPP
@@ -6,6 +6,12 @@
 #include "config.hpp"
 #include "exceptions/vcs-exception.hpp"
 #include "commands/status.hpp"
+#include "commands/commit.hpp"
+#include "commands/hash-object.hpp"
+#include "diff_engine.hpp"
+#include "commit_graph.hpp"
+#include "sparse_checkout.hpp"
+#include "object_stream.hpp"
 #include <map>
 
 class MergeCommand : public Command {
@@ -13,7 +19,6 @@ public:
     void help() override;
     void execute(std::vector<std::string>& args) override;
     void validate(std::vector<std::string>& args) override;
-    void solve(const std::string& tree_hash, std::string path, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files);
 };
 
 #endif // MERGE_HPP
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "utils.hpp"
 #include "config.hpp"
 #include "cat-file.hpp"
+#include "commit_graph.hpp"
+#include "sparse_checkout.hpp"
 
 class ResetCommand : public Command {
 public:
@@ -0,0 +1,25 @@
+#ifndef SPARSE_CHECKOUT_COMMAND_HPP
+#define SPARSE_CHECKOUT_COMMAND_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "sparse_checkout.hpp"
+#include <map>
+
+class SparseCheckoutCommand : public Command {
+private:
+    std::string subcommand;
+    std::string sparse_index_flag;   // "--sparse-index", "--no-sparse-index" or empty to keep the current setting
+    std::vector<std::string> dirs;
+
+    // Brings the working directory from 'old_sparse' to 'new_sparse', only files that enter or leave the checkout are touched
+    void apply(const SparseCheckout& old_sparse, const SparseCheckout& new_sparse);
+
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+};
+
+#endif // SPARSE_CHECKOUT_COMMAND_HPP
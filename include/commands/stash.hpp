@@ -8,6 +8,7 @@
 #include "commands/diff.hpp"
 #include "models/tree.hpp"
 #include "models/index.hpp"
+#include "sparse_checkout.hpp"
 #include "exceptions/vcs-exception.hpp"
 #include <map>
 
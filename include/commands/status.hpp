@@ -6,6 +6,8 @@
 #include "commands.hpp"
 #include "utils.hpp"
 #include "config.hpp"
+#include "diff_engine.hpp"
+#include "sparse_checkout.hpp"
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -17,6 +19,8 @@ enum class FileState {
     NEW_FILE,
     MODIFIED,
     DELETED,
+    RENAMED,
+    COPIED,
     UNKNOWN
 };
 
@@ -25,15 +29,16 @@ private:
     std::vector<std::string> modified_files;
     std::vector<std::string> untracked_files;
     std::vector<std::string> deleted_files;
+    std::time_t index_mtime = 0;    // entries this recent are racy, their files are hashed whatever their stat data
     
-    void process_file(const fs::path& path, const std::map<std::string, std::pair<std::string, std::string>>& index_map);
-    void iterate_directory(const fs::path& path, const std::set<std::string>& ignore_list, const std::map<std::string, std::pair<std::string, std::string>>& index_map);
+    void process_file(const fs::path& path, const std::map<std::string, IndexEntry>& index_map);
+    void iterate_directory(const fs::path& path, const std::set<std::string>& ignore_list, const std::map<std::string, IndexEntry>& index_map);
     void print_modified_files();
     void print_untracked_files();
     void print_deleted_files();
     void get_index_files(std::map<std::string, std::pair<std::string, std::string>>& index_files);
-    void get_last_commit_files(std::map<std::string, std::pair<std::string, std::string>>& last_commit_files);
-    void solve(const std::string& tree_hash, std::string path, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files);
+    void get_last_commit_files(std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, std::map<std::string, std::pair<std::string, std::string>>& index_files);
+    void solve(const std::string& tree_hash, std::string path, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, const std::map<std::string, std::pair<std::string, std::string>>& index_files);
     void compare_staged_and_last_commit(std::map<std::string, std::pair<std::string, std::string>>& index_files, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, std::vector<std::pair<FileState, std::string>>& changes);
     void print_changes(const std::vector<std::pair<FileState, std::string>>& changes);
 
@@ -0,0 +1,27 @@
+#ifndef WORKTREE_HPP
+#define WORKTREE_HPP
+
+#include "commands.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+class WorktreeCommand : public Command {
+private:
+    std::string subcommand;
+
+    // Creates the worktree's .vcs/ with its own HEAD and index, objects/, refs/, logs/, worktrees/, the commit-graph
+    // and the bitmaps link to the main one
+    void add_worktree(const std::string& path, const std::string& branch);
+
+    void list_worktrees();
+
+public:
+    void help() override;
+    void execute(std::vector<std::string>& args) override;
+    void validate(std::vector<std::string>& args) override;
+};
+
+#endif // WORKTREE_HPP
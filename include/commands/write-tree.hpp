@@ -7,6 +7,7 @@
 #include "models/tree.hpp"
 #include "utils.hpp"
 #include "config.hpp"
+#include "sparse_checkout.hpp"
 #include <sstream>
 #include <fstream>
 #include <map>
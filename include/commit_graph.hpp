@@ -0,0 +1,83 @@
+#ifndef COMMIT_GRAPH_HPP
+#define COMMIT_GRAPH_HPP
+
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <ctime>
+
+struct CommitNode {
+    std::string tree_hash;
+    std::vector<std::string> parents; // first parent is the branch the commit was made on
+    std::time_t time;                 // committer timestamp
+    uint32_t generation;              // 1 for root commits, 1 + max(parents) otherwise, 0 until computed
+};
+
+// Read-only view of .vcs/commit-graph, mapped into memory. The file holds one fixed-size row per commit sorted by
+// commit id: id, root tree id, parent row numbers, commit time and generation, so a lookup is a binary search
+// instead of inflating and parsing the commit object.
+class CommitGraphFile {
+private:
+    const unsigned char* data = nullptr;
+    std::size_t length = 0;
+    uint32_t count = 0;
+
+    // .vcs/commit-graph-bloom, one filter per row in the same order, unused when its row count doesn't match
+    const unsigned char* bloom_data = nullptr;
+    std::size_t bloom_length = 0;
+
+    const unsigned char* get_row(uint32_t position) const;
+    bool find(const unsigned char* id, uint32_t& position) const;
+    std::string get_filter(uint32_t position) const;
+
+public:
+    CommitGraphFile();  // an empty graph when the file is missing or unreadable
+    ~CommitGraphFile();
+    CommitGraphFile(const CommitGraphFile&) = delete;
+    CommitGraphFile& operator=(const CommitGraphFile&) = delete;
+
+    // One mapping for the whole process, opened on first use. Rows are keyed by commit id, so a mapping older than
+    // the file only lacks the commits added since, which callers then parse from their objects.
+    static const CommitGraphFile& get_shared();
+
+    uint32_t size() const { return count; }
+
+    // Fills 'node' and returns true when the commit has a row
+    bool lookup(const std::string& commit_hash, CommitNode& node) const;
+
+    // False when the commit certainly didn't change 'path' (a file or directory) compared to its first parent.
+    // True when it may have, or when the commit has no filter.
+    bool may_have_changed(const std::string& commit_hash, const std::string& path) const;
+
+    // Adds the commit and those of its ancestors that have no row yet. Only the new commits are parsed and diffed
+    // for their Bloom filters, existing rows and filters are copied over with their parent row numbers shifted.
+    static void add_commit(const std::string& commit_hash);
+};
+
+// Ancestry queries over the commit history. Commits come from the commit-graph file when they have a row there,
+// otherwise they are parsed from their objects. Either way they are kept in memory after the first use.
+class CommitGraph {
+private:
+    std::unordered_map<std::string, CommitNode> nodes;
+    CommitGraphFile graph_file;
+
+    CommitNode& load_commit(const std::string& commit_hash);
+
+public:
+    const CommitNode& get_commit(const std::string& commit_hash);
+
+    uint32_t get_generation(const std::string& commit_hash);
+
+    // Best common ancestors of both commits, none of them is an ancestor of another. Highest generation first.
+    std::vector<std::string> get_merge_bases(const std::string& commit_hash1, const std::string& commit_hash2);
+
+    // First of get_merge_bases, empty when the histories are unrelated
+    std::string get_merge_base(const std::string& commit_hash1, const std::string& commit_hash2);
+
+    // True when 'ancestor' is reachable from 'descendant' (a commit is its own ancestor)
+    bool is_ancestor(const std::string& ancestor, const std::string& descendant);
+};
+
+#endif // COMMIT_GRAPH_HPP
@@ -2,6 +2,7 @@
 #define CONFIG_HPP
 
 #include <string>
+#include <cstddef>
 
 namespace config {
     const std::string VCS_DIR           = ".vcs/";
@@ -9,13 +10,49 @@ namespace config {
     const std::string LOG_REFS_DIR      = ".vcs/logs/refs/";
     const std::string LOG_REFS_HEAD_DIR = ".vcs/logs/refs/heads/";
     const std::string OBJECTS_DIR       = ".vcs/objects/";
+    const std::string ALTERNATES_FILE   = ".vcs/objects/info/alternates";
     const std::string REFS_DIR          = ".vcs/refs/";
     const std::string REFS_HEAD_DIR     = ".vcs/refs/heads/";
+    const std::string REFS_REMOTES_DIR  = ".vcs/refs/remotes/";
     const std::string HEAD_FILE         = ".vcs/HEAD";
     const std::string INDEX_FILE        = ".vcs/index";
+    const std::string MERGE_HEAD_FILE   = ".vcs/MERGE_HEAD";
+    const std::string COMMIT_GRAPH_FILE = ".vcs/commit-graph";
+    const std::string BLOOM_FILE        = ".vcs/commit-graph-bloom";
+    const std::string BITMAP_FILE       = ".vcs/bitmaps";
+    const std::string SPARSE_CHECKOUT_FILE = ".vcs/info/sparse-checkout";
+    const std::string SPARSE_INDEX_FILE = ".vcs/info/sparse-index";
+    const std::string WORKTREES_DIR     = ".vcs/worktrees/";
     const std::string STASH             = ".vcs/refs/stash";
     const std::string LOG_STASH         = ".vcs/logs/refs/stash";
     const std::string VCS_IGNORE        = ".vcsignore";
+
+    // Upper bound for memory held by in-flight tasks of parallel stages (diff, checkout)
+    const std::size_t PARALLEL_MEMORY_LIMIT = 256 * 1024 * 1024;
+
+    // Rename detection: minimum similarity (percent) and the most file pairs compared for inexact renames
+    const int RENAME_SIMILARITY         = 50;
+    const std::size_t RENAME_PAIR_LIMIT = 100000;
+
+    // Changed-path Bloom filters: bits per changed path, probes per path, and the most paths a filter holds before
+    // it's replaced by one that always answers "maybe"
+    const std::size_t BLOOM_BITS_PER_PATH = 10;
+    const int BLOOM_PROBES                = 7;
+    const std::size_t BLOOM_MAX_PATHS     = 512;
+
+    // gc: a reachability bitmap is stored for every branch head and every this many first-parent commits below it,
+    // and unreachable objects younger than the grace period are kept, a command may still be about to use them
+    const int BITMAP_COMMIT_INTERVAL = 100;
+    const int GC_PRUNE_GRACE_DAYS    = 14;
+
+    // Alternates: how deep alternate object directories may list alternates of their own
+    const int ALTERNATES_MAX_DEPTH = 5;
+
+    // Word diff: line pairs needing more token edits than this are shown as whole lines
+    const int WORD_DIFF_MAX_EDITS = 1000;
+
+    // Blame: a parent's blob needing more line edits than this counts as rewritten, its lines stay with the commit
+    const int BLAME_MAX_EDITS = 10000;
 }
 
 #endif // CONFIG_HPP
\ No newline at end of file
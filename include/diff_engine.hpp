@@ -0,0 +1,59 @@
+#ifndef DIFF_ENGINE_HPP
+#define DIFF_ENGINE_HPP
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <map>
+
+struct RenameMatch {
+    std::string old_path;
+    std::string new_path;
+    int similarity; // 0 - 100
+    bool is_copy;
+};
+
+struct FileChange {
+    std::string filepath;
+    std::pair<std::string, std::string> old_file; // {mode, blob_hash}, empty when the file was added
+    std::pair<std::string, std::string> new_file; // {mode, blob_hash}, empty when the file was deleted
+};
+
+namespace diff_engine {
+
+    using FileMap = std::map<std::string, std::pair<std::string, std::string>>; // {file_path, {mode, blob_hash}}
+
+    // Files that differ between two trees in path order. Subtrees with the same hash on both sides are never read,
+    // so the cost follows the size of the difference. An empty hash stands for an empty tree.
+    std::vector<FileChange> diff_trees(const std::string& old_tree_hash, const std::string& new_tree_hash, const std::string& path = "");
+
+    // Maps every line of both sides to a small integer id so the diff compares ints instead of strings.
+    void intern_lines(const std::vector<std::string>& old_lines, const std::vector<std::string>& new_lines, std::vector<int>& old_ids, std::vector<int>& new_ids);
+
+    // Myers O((N+M)D) edit distance, only the number of deleted and added lines is returned: {deleted, added}
+    std::pair<int, int> count_line_changes(const std::vector<std::string>& old_lines, const std::vector<std::string>& new_lines);
+
+    // Shortest edit script between two sequences (linear-space Myers), one op per element: '=' kept, '-' deleted,
+    // '+' added. Memory is O(N+M) whatever the distance. Returns an empty script when more than 'max_edits' deletions
+    // and additions are needed, found after O((N+M) * max_edits) steps at most.
+    std::vector<char> get_edit_script(const std::vector<std::string>& old_tokens, const std::vector<std::string>& new_tokens, int max_edits);
+
+    // Three-way merge of line sequences (diff3): regions changed on one side only take that side, regions changed
+    // differently on both sides are wrapped in conflict markers. Returns false when there was a conflict.
+    bool merge_lines(const std::vector<std::string>& base_lines, const std::vector<std::string>& ours_lines, const std::vector<std::string>& theirs_lines, const std::string& ours_label, const std::string& theirs_label, std::vector<std::string>& merged_lines);
+
+    // Cuts a line into words, runs of whitespace and single punctuation characters, joining the tokens gives the line back
+    std::vector<std::string> tokenize_words(const std::string& line);
+
+    // Splits two file maps into deleted, added and modified files, modified files keep their old {mode, blob_hash}
+    void split_changes(const FileMap& old_files, const FileMap& new_files, FileMap& deleted_files, FileMap& added_files, FileMap& modified_files);
+
+    // Pairs every added file with the deleted file it most likely came from.
+    // Identical blob hashes are matched first, the rest by a minhash estimate of their shared content chunks.
+    // Added files that match one of 'copy_sources' (files on both sides whose content changed between old and new,
+    // with their old {mode, blob_hash}) are reported as copies. With 'is_exact_only' no blob is read, only identical
+    // hashes are paired.
+    std::vector<RenameMatch> detect_renames(const FileMap& deleted_files, const FileMap& added_files, const FileMap& copy_sources, bool is_exact_only = false);
+}
+
+#endif // DIFF_ENGINE_HPP
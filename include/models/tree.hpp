@@ -8,6 +8,16 @@
 #include <vector>
 #include <map>
 
+// One line of a tree object: <mode> <type> <hash> <mtime> <size> <name>
+struct TreeEntry {
+    std::string mode;
+    std::string type;
+    std::string hash;
+    std::time_t mtime;
+    std::string size;
+    std::string name;
+};
+
 class Node {
 public:
     std::string fs_name;
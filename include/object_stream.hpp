@@ -0,0 +1,44 @@
+#ifndef OBJECT_STREAM_HPP
+#define OBJECT_STREAM_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// Reads an object from .vcs/objects/ without inflating it whole. The "<type> <size>\0" header is parsed when the
+// stream is opened, read() then inflates the content piece by piece straight into the caller's buffer, so memory
+// stays the same whatever the size of the object.
+class ObjectStream {
+private:
+    std::ifstream file;
+    z_stream zs{};
+    std::vector<char> in_buffer;
+    bool is_end = false;
+
+    std::string obj_type;
+    std::size_t obj_size = 0;
+
+    // Content inflated along with the header, handed out before inflating any more
+    std::vector<char> pending;
+    std::size_t pending_begin = 0;
+    std::size_t pending_end = 0;
+
+    std::size_t inflate_some(char* out, std::size_t capacity);
+
+public:
+    explicit ObjectStream(const std::string& obj_path);   // throws runtime_error when the object can't be read
+    ~ObjectStream();
+    ObjectStream(const ObjectStream&) = delete;
+    ObjectStream& operator=(const ObjectStream&) = delete;
+
+    const std::string& type() const { return obj_type; }
+
+    // Content size from the header
+    std::size_t size() const { return obj_size; }
+
+    // Up to 'capacity' bytes of content, 0 once all of it was read
+    std::size_t read(char* out, std::size_t capacity);
+};
+
+#endif // OBJECT_STREAM_HPP
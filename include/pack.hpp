@@ -0,0 +1,62 @@
+#ifndef PACK_HPP
+#define PACK_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A pack moves objects between repositories (fetch, clone) as one stream. Objects go as they are stored in
+// .vcs/objects/, already deflated, so the sender never inflates them. Integers are big-endian:
+//   header   "VCSP", version, object count                       3 x 4 bytes
+//   objects  object id, size of the stored file, stored file     20 + 8 + size bytes each
+class PackWriter {
+private:
+    std::ostream& out;
+    std::vector<char> buffer;
+
+public:
+    // Writes the header
+    PackWriter(std::ostream& out, uint32_t object_count);
+
+    // Copies the stored object file at 'object_path' into the pack piece by piece
+    void add(const std::string& object_hash, const std::string& object_path);
+};
+
+// Stores the objects of a pack in .vcs/objects/ one at a time, memory stays the same whatever the size of the pack.
+// An object is written aside, inflated to check its content against its id and only then renamed into place, so a
+// broken or truncated pack leaves no broken object behind.
+class PackReader {
+private:
+    std::istream& in;
+    std::vector<char> buffer;
+    uint32_t remaining_count = 0;
+    std::size_t stored_count = 0;
+
+    void skip(uint64_t size);
+
+public:
+    // Reads the header, throws runtime_error when the stream isn't a pack
+    explicit PackReader(std::istream& in);
+
+    // Reads the next object, false once all of them were read. Objects already in .vcs/objects/ are skipped.
+    bool read_next();
+
+    // Objects that were new to .vcs/objects/
+    std::size_t get_stored_count() const { return stored_count; }
+};
+
+// Objects the other side is missing to have the 'want_hashes' commits when it has the 'have_hashes' ones. Haves this
+// repository doesn't know are ignored. New commits are found by walking from the wants down to the commits reachable
+// from a have, then only their trees are walked, skipping everything under the trees of the common commits they
+// build on. Commits first, then trees and blobs.
+std::vector<std::string> get_pack_objects(const std::vector<std::string>& want_hashes, const std::vector<std::string>& have_hashes);
+
+// Streams {object id, absolute path of the stored file} objects through a pack into .vcs/objects/ of the current
+// repository, one object in flight at a time. Returns how many of them were new.
+std::size_t transfer_objects(const std::vector<std::pair<std::string, std::string>>& objects);
+
+#endif // PACK_HPP
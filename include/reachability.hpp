@@ -0,0 +1,58 @@
+#ifndef REACHABILITY_HPP
+#define REACHABILITY_HPP
+
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// EWAH (word-aligned hybrid) compression of plain bitmaps. Every marker word is followed by its literal words:
+// bit 0 is the value of a run of identical all-0 or all-1 words, bits 1-32 its length, bits 33-63 the number of
+// literal words after the run.
+namespace ewah {
+    std::vector<uint64_t> compress(const std::vector<uint64_t>& words);
+
+    // Throws runtime_error when the words don't decode to exactly 'word_count' words
+    std::vector<uint64_t> decompress(const std::vector<uint64_t>& compressed, std::size_t word_count);
+}
+
+// Starting points of everything the repository still needs: branch heads and their reflogs, fetched branches, the
+// stash with its saved indexes and the blobs they stage, and for every worktree a detached HEAD, MERGE_HEAD and the
+// blobs in the index (with every object under the trees of collapsed sparse index directories).
+void collect_roots(std::vector<std::string>& commit_hashes, std::vector<std::string>& object_hashes);
+
+// Every object file under .vcs/objects/, sorted
+std::vector<std::string> list_loose_objects();
+
+// Reachability bitmaps of selected commits, stored in .vcs/bitmaps. Bit i of a bitmap is the i-th object of a
+// sorted object table, and a commit's bitmap holds every commit, tree and blob reachable from it. Walks stop at
+// commits that have one and OR it in, so only history newer than the last 'vcs gc' is walked object by object.
+class ReachabilityIndex {
+private:
+    std::vector<std::string> object_hashes;                         // sorted, a bit position is an index in here
+    std::unordered_map<std::string, std::vector<uint64_t>> bitmaps; // uncompressed, by commit hash
+
+    int find_position(const std::string& object_hash) const;
+
+public:
+    // Empty when the file is missing or can't be read
+    void load();
+
+    void write() const;
+
+    std::size_t size() const { return object_hashes.size(); }
+
+    std::size_t bitmap_count() const { return bitmaps.size(); }
+
+    bool contains(const std::vector<uint64_t>& bits, const std::string& object_hash) const;
+
+    // Sets the bit of every object reachable from the roots. Objects missing from the table go to 'other_hashes'.
+    void get_reachable(const std::vector<std::string>& commit_hashes, const std::vector<std::string>& object_hashes, std::vector<uint64_t>& bits, std::unordered_set<std::string>& other_hashes) const;
+
+    // New table over 'object_hashes' with bitmaps for 'commit_hashes'. Older commits go first so the newer ones
+    // reuse their bitmaps.
+    void build(const std::vector<std::string>& object_hashes, const std::vector<std::string>& commit_hashes);
+};
+
+#endif // REACHABILITY_HPP
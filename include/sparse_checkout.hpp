@@ -0,0 +1,62 @@
+#ifndef SPARSE_CHECKOUT_HPP
+#define SPARSE_CHECKOUT_HPP
+
+#include "models/index.hpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+// Cone-mode sparse checkout. The cones are directories listed one per line in .vcs/info/sparse-checkout; a file is
+// in the checkout when it's at the top level, directly inside a parent directory of a cone, or anywhere under a
+// cone. Tracked files outside of it are skip-worktree: they keep their index entry but aren't written to the working
+// directory, and status and diff don't look for them there.
+//
+// With a sparse index (.vcs/info/sparse-index exists) a directory outside of the checkout whose files are exactly
+// those of a tree is a single index entry "<dir>/ <tree-hash> <size> 040000 <mtime>", so the index grows with the
+// cones rather than with the repository. Commands that need every file expand these entries first.
+class SparseCheckout {
+private:
+    bool is_enabled = false;
+    bool is_sparse_index = false;
+    std::set<std::string> cone_dirs;     // everything under them is checked out
+    std::set<std::string> parent_dirs;   // only the files directly inside, "" for the top level
+
+    bool is_under_cone(const std::string& dirpath) const;
+
+    void collapse_tree(std::map<std::string, IndexEntry>& index_entries, const std::string& tree_hash, const std::string& path) const;
+
+public:
+    SparseCheckout();   // reads the cones, disabled when the file is missing
+
+    // Checkout of the given cones, or one that isn't enabled when 'enable' is false
+    explicit SparseCheckout(const std::vector<std::string>& dirs, bool enable = true);
+
+    bool enabled() const { return is_enabled; }
+
+    bool sparse_index() const { return is_sparse_index; }
+
+    void set_sparse_index(bool enable) { is_sparse_index = is_enabled && enable; }
+
+    const std::set<std::string>& get_cone_dirs() const { return cone_dirs; }
+
+    // Writes the cones to .vcs/info/sparse-checkout, a disabled checkout removes the file
+    void save() const;
+
+    // True when the file at 'filepath' is tracked without being in the working directory
+    bool is_skip_worktree(const std::string& filepath) const;
+
+    // True when no file anywhere under the directory is in the checkout
+    bool is_outside(const std::string& dirpath) const;
+
+    // Entries under an out-of-cone directory of 'tree_hash' become one entry for the directory, when they have the
+    // same files, modes and blobs as the tree there. Nothing changes without a sparse index.
+    void collapse_index(std::map<std::string, IndexEntry>& index_entries, const std::string& tree_hash) const;
+
+    // Directory entries are replaced by the entries of every file under their tree
+    static void expand_index(std::map<std::string, IndexEntry>& index_entries);
+
+    static bool is_sparse_dir(const IndexEntry& entry) { return entry.mode == "040000"; }
+};
+
+#endif // SPARSE_CHECKOUT_HPP
@@ -0,0 +1,131 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include "config.hpp"
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+// Runs tasks [0, task_count) on worker threads and hands the results back to the calling thread in index order.
+// Tasks reserve the memory they are going to use, a task waits while the reservations are over the limit.
+// The task the output is waiting for never waits, so the pipeline always drains.
+template <typename Result>
+class OrderedTaskPool {
+private:
+    const size_t task_count;
+    const size_t memory_limit;
+    const size_t window;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::optional<Result>> results;
+    std::vector<size_t> reserved;
+    size_t next_task = 0;
+    size_t next_emit = 0;
+    size_t used_memory = 0;
+    bool stop = false;
+    std::exception_ptr error;
+
+    void worker(const std::function<Result(size_t)>& compute) {
+        while (true) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                // Don't run too far ahead of the output, finished results are kept in memory until emitted
+                cv.wait(lock, [&] { return stop || next_task >= task_count || next_task < next_emit + window; });
+                if (stop || next_task >= task_count) { return; }
+                index = next_task++;
+            }
+
+            try {
+                Result result = compute(index);
+                std::lock_guard<std::mutex> lock(mtx);
+                results[index] = std::move(result);
+                cv.notify_all();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!error) { error = std::current_exception(); }
+                stop = true;
+                cv.notify_all();
+                return;
+            }
+        }
+    }
+
+public:
+    OrderedTaskPool(size_t task_count, size_t memory_limit = config::PARALLEL_MEMORY_LIMIT) : task_count(task_count), memory_limit(memory_limit), window(4 * thread_count()), results(task_count), reserved(task_count, 0) {}
+
+    static unsigned int thread_count() {
+        const unsigned int count = std::thread::hardware_concurrency();
+        return count == 0 ? 1 : count;
+    }
+
+    // Blocks until 'bytes' fit into the memory limit, called by task 'index' before allocating.
+    void reserve(size_t index, size_t bytes) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&] { return stop || index == next_emit || used_memory + bytes <= memory_limit; });
+        used_memory += bytes;
+        reserved[index] += bytes;
+    }
+
+    // Returns part of a reservation early, whatever is left is returned once the result is emitted.
+    void release(size_t index, size_t bytes) {
+        std::lock_guard<std::mutex> lock(mtx);
+        bytes = std::min(bytes, reserved[index]);
+        used_memory -= bytes;
+        reserved[index] -= bytes;
+        cv.notify_all();
+    }
+
+    void run(const std::function<Result(size_t)>& compute, const std::function<void(size_t, Result&)>& emit) {
+        const size_t worker_count = std::min<size_t>(thread_count(), task_count);
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back(&OrderedTaskPool::worker, this, std::cref(compute));
+        }
+
+        auto shutdown = [&]() {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                stop = true;
+                cv.notify_all();
+            }
+            for (std::thread& t : workers) { t.join(); }
+        };
+
+        try {
+            for (size_t index = 0; index < task_count; ++index) {
+                Result result;
+                {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    cv.wait(lock, [&] { return error || results[index].has_value(); });
+                    if (error) { break; }
+                    result = std::move(*results[index]);
+                    results[index].reset();
+                }
+
+                emit(index, result);
+
+                std::lock_guard<std::mutex> lock(mtx);
+                used_memory -= reserved[index];
+                reserved[index] = 0;
+                next_emit = index + 1;
+                cv.notify_all();
+            }
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+
+        shutdown();
+
+        if (error) { std::rethrow_exception(error); }
+    }
+};
+
+#endif // THREAD_POOL_HPP
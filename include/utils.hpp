@@ -3,17 +3,20 @@
 
 #include "config.hpp"
 #include "exceptions/vcs-exception.hpp"
+#include "models/tree.hpp"
 #include <openssl/sha.h>
 #include <filesystem>
 #include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <string>
 #include <chrono>
 #include <zlib.h>
 #include <ctime>
 #include <set>
+#include <cstdint>
 
 namespace fs = std::filesystem;
 
@@ -40,6 +43,8 @@ namespace utils {
     inline constexpr const char* DELETED   = "[ DELETED   ] ";
     inline constexpr const char* NEW_FILE  = "[ NEW FILE  ] ";
     inline constexpr const char* CONFLICT  = "[ CONFLICT  ] ";
+    inline constexpr const char* RENAMED   = "[ RENAMED   ] ";
+    inline constexpr const char* COPIED    = "[ COPIED    ] ";
 
     enum class DIR_STATUS {
         ALREADY_EXIST,
@@ -59,12 +64,24 @@ namespace utils {
         std::cout << '\n';
     }
 
+    // Same layout as write() but returned as a string, for output that is built off the main thread.
+    template <typename... T>
+    std::string format(T&&... args) {
+        std::ostringstream oss;
+        ((oss << args << " "), ...);
+        return oss.str();
+    }
+
     void clear_screen();
 
     bool is_directory_exist(const std::string& path);
 
     bool is_file_exist(const std::string& path);
 
+    // Where a replacement for the file at 'path' has to be renamed to: the target when 'path' is a symlink (a
+    // worktree's link to a file of its main repository), so the link isn't replaced by a copy
+    std::string resolve_symlink(const std::string& path);
+
     std::string get_current_path();
 
     DIR_STATUS create_directory(const std::string& path);
@@ -73,6 +90,28 @@ namespace utils {
 
     void create_vcs_structure();
 
+    // Object directories listed in .vcs/objects/info/alternates (and in their own alternates), absolute, read once.
+    // Lock-free after the first read, the list stays valid for the life of the process.
+    const std::vector<std::string>& get_alternate_dirs();
+
+    // Reads the alternates again after changing into another repository, no other thread may be reading objects
+    void reload_alternate_dirs();
+
+    // Runs the rest of a scope from inside the repository at 'path', as every path in config is relative to the
+    // current directory. The previous directory and its alternates are back once the scope ends, exception or not.
+    class RepositoryScope {
+    private:
+        fs::path prev_path;
+
+    public:
+        explicit RepositoryScope(const fs::path& path);
+        ~RepositoryScope();
+
+        RepositoryScope(const RepositoryScope&) = delete;
+        RepositoryScope& operator=(const RepositoryScope&) = delete;
+    };
+
+    // Path of the object in .vcs/objects/, or in an alternate object directory when only that one has it
     std::string get_object_path(const std::string& obj_hash);
 
     bool is_exist_obj(const std::string& obj_hash);
@@ -113,6 +152,13 @@ namespace utils {
 
     std::string get_current_branch();
 
+    // Working directories sharing the objects and refs of this repository, absolute: the main one first, then the ones
+    // added with 'vcs worktree add' that still exist
+    std::vector<std::string> get_worktree_paths();
+
+    // Worktree (the current one included) that has 'branch' checked out, empty when there is none
+    std::string find_branch_worktree(const std::string& branch);
+
     std::string get_commit_hash(const std::string& branch_name);
 
     std::set<std::string> load_ignore_list();
@@ -121,6 +167,8 @@ namespace utils {
 
     std::string get_tree_hash_from_commit(const std::string& commit_hash);
 
+    std::time_t get_commit_timestamp(const std::string& commit_hash);
+
     std::vector<std::string> get_all_branches(const std::string& path);
 
     std::string get_head_commit_hash();
@@ -141,16 +189,59 @@ namespace utils {
 
     void get_lines_from_blob(const std::string& hash, std::vector<std::string>& lines);
 
+    std::string get_blob_content(const std::string& hash);
+
     bool is_commit_exists_on_branch(const std::string& branch, const std::string& commit_hash);
 
     void warning_checkout();
 
     void solve(const std::string& tree_hash, std::stringstream& buffer, std::string path);
 
+    std::vector<TreeEntry> read_tree(const std::string& tree_hash);
+
+    // 20 raw bytes of a hex object hash for the binary files in .vcs/, empty when it isn't one
+    std::string hash_to_raw(const std::string& hash);
+
+    std::string raw_to_hash(const unsigned char* raw);
+
+    // Big-endian integers of the binary files in .vcs/ (commit graph, bitmaps)
+    uint32_t read_u32(const unsigned char* p);
+
+    void write_u32(unsigned char* p, uint32_t value);
+
+    uint64_t read_u64(const unsigned char* p);
+
+    void write_u64(unsigned char* p, uint64_t value);
+
+    // Entry at 'path' ("dir/file" or "dir"), only the trees along the path are read. False when there is none.
+    bool find_tree_entry(const std::string& tree_hash, const std::string& path, TreeEntry& entry);
+
+    void read_index(std::map<std::string, IndexEntry>& index_entries, const std::string& index_path = config::INDEX_FILE);
+
+    void write_index(const std::map<std::string, IndexEntry>& index_entries);
+
+    void remove_worktree_file(const std::string& filepath);
+
     void clean_working_directory();
 
     void make_checkout();
 
+    // Writes {path, {mode, blob_hash}} files and returns their index entries in the same order. Directories are
+    // created first, then worker threads inflate and write the files, each reusing its own buffers.
+    std::vector<IndexEntry> write_worktree_files(const std::vector<std::pair<std::string, std::pair<std::string, std::string>>>& files);
+
+    // Tree of the commit HEAD points at, empty when the current branch has no commits yet
+    std::string get_head_tree_hash();
+
+    // True when the file still has the content and mode recorded in the index entry, its size and mtime are then
+    // refreshed. Files whose size and mtime already match the entry aren't read.
+    bool refresh_index_entry(IndexEntry& entry);
+
+    // Brings the working directory and the index from 'old_tree_hash' (what HEAD has checked out) to 'new_tree_hash'.
+    // Only paths that differ between the trees are deleted or written, plus tracked files with staged or unstaged
+    // changes, which are reverted. Every other file is left alone and keeps its index entry.
+    void checkout_tree(const std::string& old_tree_hash, const std::string& new_tree_hash);
+
     bool is_path_ignored(const fs::path& path, bool is_directory, const std::set<std::string>& ignore_list);
 
     void get_lines_from_file(const std::string& path, std::vector<std::string>& lines);
@@ -44,6 +44,9 @@ void CommandExecutor::execute(CommandParams& command) {
     case CommandType::MERGE:
         cmd = std::make_unique<MergeCommand>();
         break;
+    case CommandType::MERGE_BASE:
+        cmd = std::make_unique<MergeBaseCommand>();
+        break;
     case CommandType::RESET:
         cmd = std::make_unique<ResetCommand>();
         break;
@@ -53,6 +56,30 @@ void CommandExecutor::execute(CommandParams& command) {
     case CommandType::STASH:
         cmd = std::make_unique<StashCommand>();
         break;
+    case CommandType::GC:
+        cmd = std::make_unique<GcCommand>();
+        break;
+    case CommandType::COUNT_OBJECTS:
+        cmd = std::make_unique<CountObjectsCommand>();
+        break;
+    case CommandType::BLAME:
+        cmd = std::make_unique<BlameCommand>();
+        break;
+    case CommandType::SPARSE_CHECKOUT:
+        cmd = std::make_unique<SparseCheckoutCommand>();
+        break;
+    case CommandType::WORKTREE:
+        cmd = std::make_unique<WorktreeCommand>();
+        break;
+    case CommandType::CLONE:
+        cmd = std::make_unique<CloneCommand>();
+        break;
+    case CommandType::FETCH:
+        cmd = std::make_unique<FetchCommand>();
+        break;
+    case CommandType::BUNDLE:
+        cmd = std::make_unique<BundleCommand>();
+        break;
     default:
         const std::string error_msg = "Parser failed.";
         throw std::logic_error(error_msg);
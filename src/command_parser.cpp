@@ -14,9 +14,18 @@ CommandType CommandParser::command_type(const std::string& cmd) {
     if (cmd == "branch") return CommandType::BRANCH;
     if (cmd == "checkout") return CommandType::CHECKOUT;
     if (cmd == "merge") return CommandType::MERGE;
+    if (cmd == "merge-base") return CommandType::MERGE_BASE;
     if (cmd == "reset") return CommandType::RESET;
     if (cmd == "revert") return CommandType::REVERT;
     if (cmd == "stash") return CommandType::STASH;
+    if (cmd == "gc") return CommandType::GC;
+    if (cmd == "count-objects") return CommandType::COUNT_OBJECTS;
+    if (cmd == "blame") return CommandType::BLAME;
+    if (cmd == "sparse-checkout") return CommandType::SPARSE_CHECKOUT;
+    if (cmd == "worktree") return CommandType::WORKTREE;
+    if (cmd == "clone") return CommandType::CLONE;
+    if (cmd == "fetch") return CommandType::FETCH;
+    if (cmd == "bundle") return CommandType::BUNDLE;
     return CommandType::UNKNOWN; 
 }
 
@@ -65,11 +65,15 @@ void process_file(const bool is_status_flag, const fs::path& file_path, std::uno
     if(is_status_flag) utils::write(utils::OK, hash, file_path.string());
 };
 
-void iterate_directory(const bool is_status_flag, const fs::path& path, const std::set<std::string>& ignore_list, std::unordered_map<std::string, std::tuple<std::string, std::string, std::string, std::time_t>>& index_map) {
+void iterate_directory(const bool is_status_flag, const fs::path& path, const std::set<std::string>& ignore_list, const SparseCheckout& sparse, std::unordered_map<std::string, std::tuple<std::string, std::string, std::string, std::time_t>>& index_map) {
     if (fs::is_regular_file(path)) {
         // Directly process a single file
         if (!utils::is_ignored(path, false, ignore_list)) {
             fs::path rel_path = fs::relative(path, fs::current_path());
+            if (sparse.is_skip_worktree(rel_path.string())) {
+                utils::write(utils::WARN, "Skipping '" + rel_path.string() + "', it's outside of the sparse checkout.");
+                return;
+            }
             process_file(is_status_flag, rel_path, index_map);
         }
         return;
@@ -81,7 +85,13 @@ void iterate_directory(const bool is_status_flag, const fs::path& path, const st
         if (utils::is_ignored(entry.path(), entry.is_directory(), ignore_list)) continue;
 
         if (entry.is_directory()) {
-            iterate_directory(is_status_flag, entry.path(), ignore_list, index_map);
+            // Paths outside of the sparse checkout stay as the index has them, the directory isn't walked
+            const std::string rel_dir = fs::relative(entry.path(), fs::current_path()).string();
+            if (sparse.is_outside(rel_dir)) {
+                utils::write(utils::WARN, "Skipping '" + rel_dir + "', it's outside of the sparse checkout.");
+                continue;
+            }
+            iterate_directory(is_status_flag, entry.path(), ignore_list, sparse, index_map);
         } else {
             fs::path rel_path = fs::relative(entry.path(), fs::current_path());
             process_file(is_status_flag, rel_path, index_map);
@@ -97,6 +107,7 @@ void AddCommand::execute(std::vector<std::string>& args) {
     // Decompress and load existing index
     const std::string decompressed_data = utils::read_and_decompress(config::INDEX_FILE);  
     const std::set<std::string> ignore_list = utils::load_ignore_list();
+    const SparseCheckout sparse;
     
     if (!decompressed_data.empty()) {
         std::istringstream iss(decompressed_data);
@@ -106,7 +117,8 @@ void AddCommand::execute(std::vector<std::string>& args) {
             std::string filepath, hash, size, mode;
             std::time_t mtime;
             line_stream >> filepath >> hash >> size >> mode >> mtime;
-            if (fs::exists(filepath) && !utils::is_ignored(filepath, false, ignore_list)) {
+            // Skip-worktree files and collapsed directories are missing from the working directory on purpose, they stay tracked
+            if ((sparse.is_skip_worktree(filepath) || fs::exists(filepath)) && !utils::is_ignored(filepath, false, ignore_list)) {
                 index_map[filepath] = {hash, size, mode, mtime};
             }
         }
@@ -117,7 +129,7 @@ void AddCommand::execute(std::vector<std::string>& args) {
     const std::string path = args.back();
 
     // Process files
-    iterate_directory(is_status_flag, path, ignore_list, index_map);
+    iterate_directory(is_status_flag, path, ignore_list, sparse, index_map);
 
     // Write and compress index
     std::ostringstream oss;
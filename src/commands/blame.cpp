@@ -0,0 +1,216 @@
+#include "commands/blame.hpp"
+
+void BlameCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs blame <file>");
+    utils::write(utils::INFO, "flag  : --incremental (print <commit> <orig-line> <final-line> <count> as soon as each commit is found)");
+    utils::write(utils::EMPTY);
+}
+
+void BlameCommand::validate(std::vector<std::string>& args) {
+    if(!args.empty() && args[0] == "--incremental") {
+        this->is_incremental = true;
+        args.erase(args.begin());
+    }
+
+    const int args_size = args.size();
+
+    if(args_size < 1) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(args_size > 1) {
+        const std::string error_msg = "Too many arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    this->path = args[0];
+    if(this->path.rfind("./", 0) == 0) { this->path = this->path.substr(2); }
+
+    const std::string head_commit_hash = utils::get_head_commit_hash();
+    if(head_commit_hash.empty() || head_commit_hash == std::string(40, '0')) {
+        const std::string error_msg = "No commits yet on the current branch.";
+        throw std::invalid_argument(error_msg);
+    }
+
+    TreeEntry entry;
+    if(!utils::find_tree_entry(utils::get_tree_hash_from_commit(head_commit_hash), this->path, entry) || entry.type != "blob") {
+        const std::string error_msg = "No such file in HEAD: " + this->path;
+        throw std::invalid_argument(error_msg);
+    }
+}
+
+const std::vector<std::string>& BlameCommand::get_blob_lines(const std::string& blob_hash) {
+    auto [it, is_new] = this->blob_lines.try_emplace(blob_hash);
+    if(is_new) { utils::get_lines_from_blob(blob_hash, it->second); }
+    return it->second;
+}
+
+const BlameAuthor& BlameCommand::get_author(const std::string& commit_hash) {
+    auto [it, is_new] = this->authors.try_emplace(commit_hash);
+    if(!is_new) { return it->second; }
+
+    std::istringstream iss(utils::read_and_decompress(utils::get_object_path(commit_hash)));
+    std::string line;
+    bool is_message = false;
+
+    while(std::getline(iss, line)) {
+        if(line.rfind("author ", 0) == 0) {
+            const size_t pos = line.find_last_of(' ');
+            it->second.username = line.substr(7, pos - 7);
+            it->second.timestamp = std::stoll(line.substr(pos + 1));
+        }
+        else if(line.rfind("committer ", 0) == 0) {
+            is_message = true;
+        }
+        else if(is_message && !line.empty()) {
+            it->second.summary = line;
+            break;
+        }
+    }
+
+    return it->second;
+}
+
+void BlameCommand::print_incremental(const std::string& commit_hash, std::vector<std::pair<int, int>> lines) {
+    if(lines.empty()) { return; }
+
+    const bool is_first = this->authors.find(commit_hash) == this->authors.end();
+    const BlameAuthor& author = get_author(commit_hash);
+
+    std::sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+
+    // A run is consecutive in both the commit's blob and the final file
+    size_t start = 0;
+    for(size_t i = 1; i <= lines.size(); ++i) {
+        if(i < lines.size() && lines[i].first == lines[i - 1].first + 1 && lines[i].second == lines[i - 1].second + 1) { continue; }
+
+        utils::write(utils::INFO, commit_hash, lines[start].first + 1, lines[start].second + 1, i - start);
+        if(is_first && start == 0) {
+            utils::write(utils::INFO, "author", author.username);
+            utils::write(utils::INFO, "author-time", author.timestamp);
+            utils::write(utils::INFO, "summary", author.summary);
+        }
+        start = i;
+    }
+}
+
+void BlameCommand::execute(std::vector<std::string>& args) {
+    const std::string head_commit_hash = utils::get_head_commit_hash();
+
+    CommitGraph graph;
+    CommitGraphFile graph_file;
+
+    TreeEntry entry;
+    utils::find_tree_entry(graph.get_commit(head_commit_hash).tree_hash, this->path, entry);
+
+    const std::vector<std::string> final_lines = get_blob_lines(entry.hash);
+    std::vector<std::string> line_commits(final_lines.size());
+    std::vector<int> orig_lines(final_lines.size());
+
+    // Commits are taken highest generation first, so every child has handed its lines down before a parent is looked at
+    std::unordered_map<std::string, BlameSuspect> suspects;
+    std::priority_queue<std::pair<uint32_t, std::string>> queue;
+
+    auto pass_lines = [&](const std::string& commit_hash, const std::string& blob_hash, std::vector<std::pair<int, int>>&& lines) {
+        if(lines.empty()) { return; }
+
+        auto [it, is_new] = suspects.try_emplace(commit_hash);
+        if(is_new) {
+            it->second.blob_hash = blob_hash;
+            queue.emplace(graph.get_generation(commit_hash), commit_hash);
+        }
+        it->second.lines.insert(it->second.lines.end(), lines.begin(), lines.end());
+    };
+
+    std::vector<std::pair<int, int>> all_lines;
+    for(int i = 0; i < int(final_lines.size()); ++i) { all_lines.emplace_back(i, i); }
+    pass_lines(head_commit_hash, entry.hash, std::move(all_lines));
+
+    while(!queue.empty()) {
+        const std::string commit_hash = queue.top().second;
+        queue.pop();
+
+        BlameSuspect suspect = std::move(suspects[commit_hash]);
+        suspects.erase(commit_hash);
+        const std::vector<std::string> parents = graph.get_commit(commit_hash).parents;
+
+        // The Bloom filter rules out a change against the first parent without reading any tree
+        if(!parents.empty() && !graph_file.may_have_changed(commit_hash, this->path)) {
+            pass_lines(parents[0], suspect.blob_hash, std::move(suspect.lines));
+            continue;
+        }
+
+        // Blob at the path in every parent, empty when the parent doesn't have the file
+        std::vector<std::string> parent_blobs;
+        for(const std::string& parent_hash : parents) {
+            TreeEntry parent_entry;
+            const bool is_found = utils::find_tree_entry(graph.get_commit(parent_hash).tree_hash, this->path, parent_entry) && parent_entry.type == "blob";
+            parent_blobs.push_back(is_found ? parent_entry.hash : "");
+        }
+
+        // Same blob as a parent: every line comes from there, nothing to diff
+        auto same_it = std::find(parent_blobs.begin(), parent_blobs.end(), suspect.blob_hash);
+        if(same_it != parent_blobs.end()) {
+            pass_lines(parents[same_it - parent_blobs.begin()], suspect.blob_hash, std::move(suspect.lines));
+            continue;
+        }
+
+        std::vector<std::pair<int, int>> remaining = std::move(suspect.lines);
+        for(size_t i = 0; i < parents.size() && !remaining.empty(); ++i) {
+            if(parent_blobs[i].empty()) { continue; }
+
+            const std::vector<std::string>& old_lines = get_blob_lines(parent_blobs[i]);
+            const std::vector<std::string>& new_lines = get_blob_lines(suspect.blob_hash);
+
+            // Line of the parent's blob every unchanged line came from, -1 for added lines. Past the cap the script is
+            // empty and no line is passed to this parent.
+            std::vector<int> origins(new_lines.size(), -1);
+            int old_pos = 0, new_pos = 0;
+            for(const char op : diff_engine::get_edit_script(old_lines, new_lines, config::BLAME_MAX_EDITS)) {
+                if(op == '=') { origins[new_pos++] = old_pos++; }
+                else if(op == '-') { ++old_pos; }
+                else { ++new_pos; }
+            }
+
+            std::vector<std::pair<int, int>> passed, kept;
+            for(const auto& [line, final_line] : remaining) {
+                if(origins[line] >= 0) { passed.emplace_back(origins[line], final_line); }
+                else { kept.emplace_back(line, final_line); }
+            }
+
+            pass_lines(parents[i], parent_blobs[i], std::move(passed));
+            remaining = std::move(kept);
+        }
+
+        // Whatever no parent had was written in this commit
+        for(const auto& [line, final_line] : remaining) {
+            line_commits[final_line] = commit_hash;
+            orig_lines[final_line] = line;
+        }
+        if(this->is_incremental) { print_incremental(commit_hash, remaining); }
+    }
+
+    if(this->is_incremental) {
+        utils::write(utils::END);
+        return;
+    }
+
+    size_t name_width = 0;
+    for(const std::string& commit_hash : line_commits) { name_width = std::max(name_width, get_author(commit_hash).username.size()); }
+
+    for(size_t i = 0; i < final_lines.size(); ++i) {
+        const BlameAuthor& author = get_author(line_commits[i]);
+
+        char date_str[32];
+        std::strftime(date_str, sizeof(date_str), "%Y-%m-%d %H:%M:%S", std::localtime(&author.timestamp));
+
+        const std::string line_number = std::to_string(i + 1);
+        const std::string number_pad(std::to_string(final_lines.size()).size() - line_number.size(), ' ');
+        const std::string name_pad(name_width - author.username.size(), ' ');
+
+        utils::write(utils::CONTENT, line_commits[i].substr(0, 7), "(" + author.username + name_pad, date_str, number_pad + line_number + ")", final_lines[i]);
+    }
+}
@@ -0,0 +1,160 @@
+#include "commands/bundle.hpp"
+
+namespace {
+    const std::string BUNDLE_SIGNATURE = "# v1 vcs bundle";
+}
+
+void BundleCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs bundle create <file> <branch-name>...");
+    utils::write(utils::INFO, "usage : vcs bundle create <file> <branch-name>... ^<branch-name-or-hash>...");
+    utils::write(utils::INFO, "usage : vcs bundle unbundle <file>");
+    utils::write(utils::INFO, "note  : ^<branch-name-or-hash> leaves out the history the receiver already has");
+    utils::write(utils::EMPTY);
+}
+
+void BundleCommand::validate(std::vector<std::string>& args) {
+    if(args.empty()) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    this->subcommand = args[0];
+    const int args_size = args.size();
+
+    if(this->subcommand != "create" && this->subcommand != "unbundle") {
+        const std::string error_msg = "Invalid subcommand: " + this->subcommand + ". Expected create or unbundle";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(args_size < (this->subcommand == "create" ? 3 : 2)) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    this->bundle_path = args[1];
+
+    if(this->subcommand == "unbundle") {
+        if(args_size > 2) {
+            const std::string error_msg = "Too many arguments";
+            throw std::invalid_argument(error_msg);
+        }
+
+        if(!utils::is_file_exist(this->bundle_path)) {
+            const std::string error_msg = "Could not open '" + this->bundle_path + "' for reading: No such file or directory";
+            throw std::invalid_argument(error_msg);
+        }
+        return;
+    }
+
+    for(int i = 2; i < args_size; ++i) {
+        const bool is_prerequisite = !args[i].empty() && args[i][0] == '^';
+        const std::string name = is_prerequisite ? args[i].substr(1) : args[i];
+
+        const std::string branch_path = config::REFS_HEAD_DIR + name;
+        const bool is_branch = utils::is_valid_branch_name(name) && utils::is_file_exist(branch_path);
+        const std::string commit_hash = is_branch ? utils::get_commit_hash(name) : name;
+
+        if(!is_prerequisite && (!is_branch || commit_hash == std::string(40, '0'))) {
+            const std::string error_msg = "Invalid arguments: branch '" + name + "' does not exist or has no commits.";
+            throw std::invalid_argument(error_msg);
+        }
+
+        if(!utils::is_valid_hash_syntax(commit_hash) || !utils::is_exist_obj(commit_hash) || CatFileCommand().get_object_type(commit_hash) != "commit") {
+            const std::string error_msg = "Invalid arguments: '" + name + "' is not a branch or a commit.";
+            throw std::invalid_argument(error_msg);
+        }
+
+        if(is_prerequisite) { this->prerequisite_hashes.push_back(commit_hash); }
+        else { this->heads[name] = commit_hash; }
+    }
+}
+
+void BundleCommand::create_bundle() {
+    std::vector<std::string> want_hashes;
+    for(const auto& [branch, commit_hash] : this->heads) { want_hashes.push_back(commit_hash); }
+
+    // Only the ids are held in memory, the objects themselves are read once, while they are written
+    const std::vector<std::string> object_hashes = get_pack_objects(want_hashes, this->prerequisite_hashes);
+
+    std::ofstream out(this->bundle_path, std::ios::binary | std::ios::trunc);
+    if(!out) {
+        const std::string error_msg = "Failed to open file: " + this->bundle_path;
+        throw std::runtime_error(error_msg);
+    }
+
+    out << BUNDLE_SIGNATURE << "\n";
+    for(const std::string& commit_hash : this->prerequisite_hashes) { out << "-" << commit_hash << "\n"; }
+    for(const auto& [branch, commit_hash] : this->heads) { out << commit_hash << " " << branch << "\n"; }
+    out << "\n";
+
+    try {
+        PackWriter writer(out, object_hashes.size());
+        for(const std::string& object_hash : object_hashes) { writer.add(object_hash, utils::get_object_path(object_hash)); }
+        out.close();
+        if(!out) { throw std::runtime_error("Failed to write bundle: " + this->bundle_path); }
+    }
+    catch(const std::runtime_error&) {
+        // Half a bundle would only fail later, on the other host
+        out.close();
+        fs::remove(this->bundle_path);
+        throw;
+    }
+
+    for(const auto& [branch, commit_hash] : this->heads) { utils::write(utils::INFO, commit_hash.substr(0, 7), branch); }
+    utils::write(utils::OK, "Created bundle '" + this->bundle_path + "' with", object_hashes.size(), "objects.");
+}
+
+void BundleCommand::unbundle() {
+    std::ifstream in(this->bundle_path, std::ios::binary);
+    if(!in) {
+        const std::string error_msg = "Failed to open file: " + this->bundle_path;
+        throw std::runtime_error(error_msg);
+    }
+
+    std::string line;
+    if(!std::getline(in, line) || line != BUNDLE_SIGNATURE) {
+        const std::string error_msg = "Not a bundle or unknown bundle version: " + this->bundle_path;
+        throw std::runtime_error(error_msg);
+    }
+
+    std::map<std::string, std::string> bundle_heads;
+    std::vector<std::string> missing_hashes;
+
+    while(std::getline(in, line) && !line.empty()) {
+        if(line[0] == '-') {
+            if(!utils::is_valid_hash_syntax(line.substr(1)) || !utils::is_exist_obj(line.substr(1))) { missing_hashes.push_back(line.substr(1)); }
+            continue;
+        }
+
+        std::istringstream line_stream(line);
+        std::string commit_hash, branch;
+        if(!(line_stream >> commit_hash >> branch) || !utils::is_valid_hash_syntax(commit_hash) || !utils::is_valid_branch_name(branch)) {
+            const std::string error_msg = "Corrupted bundle header: " + line;
+            throw std::runtime_error(error_msg);
+        }
+        bundle_heads[branch] = commit_hash;
+    }
+
+    // The bundle builds on history this repository must already have, the objects alone would be of no use
+    if(!missing_hashes.empty()) {
+        utils::write(utils::ERR, "This repository lacks the prerequisite commits of the bundle:");
+        for(const std::string& commit_hash : missing_hashes) { utils::write(utils::ERR, commit_hash); }
+        return;
+    }
+
+    PackReader reader(in);
+    while(reader.read_next()) {}
+    utils::write(utils::INFO, "Received", reader.get_stored_count(), "objects.");
+
+    FetchCommand::store_remote_heads(FetchCommand::get_remote_name(this->bundle_path), bundle_heads);
+    utils::write(utils::OK);
+}
+
+void BundleCommand::execute(std::vector<std::string>& args) {
+    utils::create_vcs_structure();
+
+    if(this->subcommand == "create") { create_bundle(); }
+    else { unbundle(); }
+}
@@ -110,6 +110,12 @@ void CheckoutCommand::switch_to_branch(const std::string& branch_name) {
         utils::write(utils::OK, "Already on branch '" + branch_name + "'.");
         return;
     }
+
+    const std::string worktree_path = utils::find_branch_worktree(branch_name);
+    if(!worktree_path.empty()) {
+        const std::string error_msg = "Branch '" + branch_name + "' is already checked out at '" + worktree_path + "'";
+        throw VCSException(error_msg);
+    }
     
     utils::warning_checkout();
 
@@ -127,17 +133,7 @@ void CheckoutCommand::switch_to_branch(const std::string& branch_name) {
         throw std::logic_error(error_msg);
     }
 
-    std::stringstream buffer;
-    utils::solve(tree_hash, buffer, ""); // adds the last commit's tree to the index file(staging area) and removes all current files.
-    
-    std::string compressed = utils::compress_zlib(buffer.str());
-    std::ofstream ofs(config::INDEX_FILE, std::ios::binary | std::ios::trunc);
-    ofs.write(compressed.data(), compressed.size());
-    ofs.close();
-
-    utils::clean_working_directory(); // because we are switching branches, we need to delete all files in the index file.
-    
-    utils::make_checkout(); // put all the files in current working directory based on the index file.
+    utils::checkout_tree(utils::get_head_tree_hash(), tree_hash); // only the files that differ from HEAD (or were changed locally) are rewritten, the index follows.
     
     switch_in_head_file(branch_name); // Update HEAD file to point to the new branch
     
@@ -167,17 +163,7 @@ void CheckoutCommand::switch_to_hash(const std::string& commit_hash) {
     
     utils::warning_checkout();
 
-    std::stringstream buffer;
-    utils::solve(tree_hash, buffer, ""); // adds the last commit's tree to the index file(staging area) and removes all current files.
-    
-    std::string compressed = utils::compress_zlib(buffer.str());
-    std::ofstream ofs_index(config::INDEX_FILE, std::ios::binary | std::ios::trunc);
-    ofs_index.write(compressed.data(), compressed.size());
-    ofs_index.close();
-
-    utils::clean_working_directory(); // because we are switching branches, we need to delete all files in the index file.
-
-    utils::make_checkout();
+    utils::checkout_tree(utils::get_head_tree_hash(), tree_hash); // only the files that differ from HEAD (or were changed locally) are rewritten, the index follows.
 
     utils::write(utils::WARN, "You are in a detached HEAD state.");
     utils::write(utils::WARN, "You cannot commit in this state.");
@@ -222,17 +208,7 @@ void CheckoutCommand::create_branch_and_switch_to_hash(const std::string& branch
 
     utils::warning_checkout();
 
-    std::stringstream buffer;
-    utils::solve(tree_hash, buffer, ""); // adds the last commit's tree to the index file(staging area) and removes all current files.
-    
-    std::string compressed = utils::compress_zlib(buffer.str());
-    std::ofstream ofs(config::INDEX_FILE, std::ios::binary | std::ios::trunc);
-    ofs.write(compressed.data(), compressed.size());
-    ofs.close();
-
-    utils::clean_working_directory(); // because we are switching branches, we need to delete all files in the index file.
-
-    utils::make_checkout();
+    utils::checkout_tree(utils::get_head_tree_hash(), tree_hash); // only the files that differ from HEAD (or were changed locally) are rewritten, the index follows.
 
     // Create the new branch file in refs/heads/<new-branch>
     const std::string new_branch_path = config::REFS_HEAD_DIR + branch_name;
@@ -0,0 +1,182 @@
+#include "commands/clone.hpp"
+
+void CloneCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs clone <path-to-repository>");
+    utils::write(utils::INFO, "usage : vcs clone <path-to-repository> <directory>");
+    utils::write(utils::INFO, "flag  : --no-hardlinks (copy the objects through a pack even on the same filesystem)");
+    utils::write(utils::EMPTY);
+}
+
+void CloneCommand::validate(std::vector<std::string>& args) {
+    if(!args.empty() && args[0] == "--no-hardlinks") {
+        this->is_no_hardlinks = true;
+        args.erase(args.begin());
+    }
+
+    const int args_size = args.size();
+
+    if(args_size < 1) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(args_size > 2) {
+        const std::string error_msg = "Too many arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    this->source_path = args[0];
+    if(!fs::is_directory(fs::path(this->source_path) / config::OBJECTS_DIR)) {
+        const std::string error_msg = "Invalid path: '" + this->source_path + "' is not a VCS repository.";
+        throw std::invalid_argument(error_msg);
+    }
+
+    // Like the source directory by default
+    this->target_path = (args_size == 2) ? args[1] : fs::canonical(this->source_path).filename().string();
+    if(fs::exists(this->target_path) && (!fs::is_directory(this->target_path) || !fs::is_empty(this->target_path))) {
+        const std::string error_msg = "Invalid path: '" + this->target_path + "' already exists and is not an empty directory.";
+        throw std::invalid_argument(error_msg);
+    }
+}
+
+std::size_t CloneCommand::link_objects(const fs::path& source_objects_dir) {
+    std::size_t object_count = 0;
+
+    for(const auto& dir : fs::directory_iterator(source_objects_dir)) {
+        const std::string prefix = dir.path().filename().string();
+        if(!dir.is_directory() || prefix.size() != 2) { continue; }
+
+        const std::string object_dir = config::OBJECTS_DIR + prefix + "/";
+        for(const auto& file : fs::directory_iterator(dir.path())) {
+            if(!file.is_regular_file() || !utils::is_valid_hash_syntax(prefix + file.path().filename().string())) { continue; }
+
+            if(utils::create_directory(object_dir) == utils::DIR_STATUS::ERROR) {
+                const std::string error_msg = "Failed to create directory: " + object_dir;
+                throw std::runtime_error(error_msg);
+            }
+
+            // Objects never change once written, both repositories can share the file
+            fs::create_hard_link(file.path(), object_dir + file.path().filename().string());
+            ++object_count;
+        }
+    }
+
+    // Relative alternates are relative to the source's object directory, they are written absolute
+    std::ifstream alternates_file(source_objects_dir / "info" / "alternates");
+    std::string line;
+    std::stringstream alternates;
+    while(std::getline(alternates_file, line)) {
+        if(!line.empty() && line[0] != '#') { alternates << fs::weakly_canonical(source_objects_dir / line).string() << "\n"; }
+    }
+
+    if(!alternates.str().empty()) {
+        fs::create_directories(fs::path(config::ALTERNATES_FILE).parent_path());
+        std::ofstream out(config::ALTERNATES_FILE, std::ios::out | std::ios::trunc);
+        if(!out) {
+            const std::string error_msg = "Failed to open file: " + config::ALTERNATES_FILE;
+            throw std::runtime_error(error_msg);
+        }
+        out << alternates.str();
+        out.close();
+    }
+
+    return object_count;
+}
+
+void CloneCommand::copy_refs(const fs::path& source_dir, const std::map<std::string, std::string>& source_heads, const std::string& source_head) {
+    const std::string username = utils::get_username();
+    const std::string timestamp = utils::get_unix_timestamp();
+
+    for(const auto& [branch, commit_hash] : source_heads) {
+        std::ofstream branch_file(config::REFS_HEAD_DIR + branch, std::ios::out | std::ios::trunc);
+        if(!branch_file) {
+            const std::string error_msg = "Failed to open file: " + config::REFS_HEAD_DIR + branch;
+            throw std::runtime_error(error_msg);
+        }
+        branch_file << commit_hash;
+        branch_file.close();
+
+        std::ofstream log_file(config::LOG_REFS_HEAD_DIR + branch, std::ios::out | std::ios::trunc);
+        if(!log_file) {
+            const std::string error_msg = "Failed to open file: " + config::LOG_REFS_HEAD_DIR + branch;
+            throw std::runtime_error(error_msg);
+        }
+        if(commit_hash != std::string(40, '0')) {
+            log_file << std::string(40, '0') << " " << commit_hash << " " << username << " " << timestamp << " clone: from " << source_dir.string() << "\n";
+        }
+        log_file.close();
+    }
+
+    // A new repository starts on 'master', the source may not have it
+    if(source_heads.find("master") == source_heads.end()) {
+        fs::remove(config::REFS_HEAD_DIR + "master");
+        fs::remove(config::LOG_REFS_HEAD_DIR + "master");
+    }
+
+    std::ofstream head_file(config::HEAD_FILE, std::ios::out | std::ios::trunc);
+    if(!head_file) {
+        const std::string error_msg = "Failed to open file: " + config::HEAD_FILE;
+        throw std::runtime_error(error_msg);
+    }
+    head_file << source_head;
+    head_file.close();
+}
+
+void CloneCommand::execute(std::vector<std::string>& args) {
+    const fs::path source_dir = fs::canonical(this->source_path);
+    const fs::path source_objects_dir = source_dir / config::OBJECTS_DIR;
+    const fs::path target_dir = fs::absolute(this->target_path).lexically_normal();
+
+    const std::map<std::string, std::string> source_heads = FetchCommand::read_branch_heads(source_dir.string());
+    const std::string source_head = utils::read_file_content((source_dir / config::HEAD_FILE).string());
+
+    utils::write(utils::INFO, "Cloning into '" + target_dir.string() + "'...");
+
+    const bool is_new_target = !fs::exists(target_dir);
+    fs::create_directories(target_dir);
+
+    try {
+        utils::RepositoryScope target_scope(target_dir);
+        utils::create_vcs_structure();
+
+        struct stat source_stat, target_stat;
+        const bool is_same_device = stat(source_objects_dir.c_str(), &source_stat) == 0 && stat(config::OBJECTS_DIR.c_str(), &target_stat) == 0 && source_stat.st_dev == target_stat.st_dev;
+
+        if(is_same_device && !this->is_no_hardlinks) {
+            const std::size_t object_count = link_objects(source_objects_dir);
+            utils::reload_alternate_dirs();
+            utils::write(utils::INFO, "Linked", object_count, "objects.");
+        }
+        else {
+            std::vector<std::string> want_hashes;
+            for(const auto& [branch, commit_hash] : source_heads) {
+                if(commit_hash != std::string(40, '0')) { want_hashes.push_back(commit_hash); }
+            }
+
+            // A detached HEAD may point at a commit no branch has
+            if(source_head.find("ref: ") == std::string::npos) { want_hashes.push_back(source_head); }
+
+            const std::size_t object_count = FetchCommand::fetch_objects(source_dir.string(), want_hashes, {});
+            utils::write(utils::INFO, "Received", object_count, "objects.");
+        }
+
+        copy_refs(source_dir, source_heads, source_head);
+
+        const std::string head_commit_hash = utils::get_head_commit_hash();
+        if(head_commit_hash.empty() || head_commit_hash == std::string(40, '0')) { utils::write_index({}); }
+        else { utils::checkout_tree("", utils::get_tree_hash_from_commit(head_commit_hash)); }
+    }
+    catch(...) {
+        // A failed clone leaves no half-made repository behind, an empty target directory given is emptied again
+        std::error_code ec;
+        if(is_new_target) { fs::remove_all(target_dir, ec); }
+        else {
+            for(const auto& entry : fs::directory_iterator(target_dir, ec)) { fs::remove_all(entry.path(), ec); }
+        }
+        throw;
+    }
+
+    utils::write(utils::OK, "Cloned '" + source_dir.string() + "' into '" + target_dir.string() + "'.");
+}
@@ -47,6 +47,12 @@ void CommitCommand::execute(std::vector<std::string>& args) {
 
     const std::string& commit_message = args[0];  // commit message is the first argument
 
+    const std::string hash = create_commit(commit_message);
+
+    utils::write(utils::OK, hash);
+}
+
+std::string CommitCommand::create_commit(const std::string& commit_message) {
     const std::string tree_hash = WriteTreeCommand::write_tree(false); // false - for status priting
 
     const std::string head_file_content = utils::read_file_content(config::HEAD_FILE);
@@ -65,12 +71,20 @@ void CommitCommand::execute(std::vector<std::string>& args) {
     std::stringstream buffer;
     buffer << "\n" << "tree " + tree_hash;
     buffer << "\n" << "parent " + parent_hash;
+
+    // A merge in progress records the merged branch as the second parent
+    const bool is_merge = utils::is_file_exist(config::MERGE_HEAD_FILE);
+    if (is_merge) {
+        buffer << "\n" << "parent " + utils::read_file_content(config::MERGE_HEAD_FILE);
+    }
+
     buffer << "\n" << "author " << username << " " << timestamp;
     buffer << "\n" << "committer " << username << " " << timestamp;
     buffer << "\n" << commit_message;
     
     // commiting the commit object
     const std::string hash = HashObjectCommand::write_obj(buffer, "commit");
+    CommitGraphFile::add_commit(hash);
 
     const std::string branch = utils::extract_ref_branch(head_file_content);
     const std::string ref_head_file_path = config::REFS_HEAD_DIR + branch;
@@ -88,8 +102,22 @@ void CommitCommand::execute(std::vector<std::string>& args) {
 
     // Appending logs to the ./vcs/logs/refs/heads/<branch-name> file
     std::ofstream log_head_branch_file(log_ref_head_file_path, std::ios::out | std::ios::app);
-    log_head_branch_file << parent_hash << " " << hash << " " << username << " " << timestamp << " commit: " << commit_message << "\n";
+    log_head_branch_file << parent_hash << " " << hash << " " << username << " " << timestamp << (is_merge ? " commit (merge): " : " commit: ") << commit_message << "\n";
     log_head_branch_file.close();
 
-    utils::write(utils::OK, hash);
+    if (is_merge) {
+        fs::remove(config::MERGE_HEAD_FILE);
+
+        // Merge staged the files of out-of-cone directories the other branch changed, the index holds the merged
+        // tree now and they collapse against it
+        const SparseCheckout sparse;
+        if (sparse.sparse_index()) {
+            std::map<std::string, IndexEntry> index_entries;
+            utils::read_index(index_entries);
+            sparse.collapse_index(index_entries, tree_hash);
+            utils::write_index(index_entries);
+        }
+    }
+
+    return hash;
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include "commands/count-objects.hpp"
+
+void CountObjectsCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs count-objects");
+    utils::write(utils::EMPTY);
+}
+
+void CountObjectsCommand::validate(std::vector<std::string>& args) {
+    if(!args.empty()) {
+        const std::string error_msg = "Too many arguments";
+        throw std::invalid_argument(error_msg);
+    }
+}
+
+void CountObjectsCommand::execute(std::vector<std::string>& args) {
+    std::vector<std::string> root_commits, root_objects;
+    collect_roots(root_commits, root_objects);
+
+    ReachabilityIndex index;
+    index.load();
+
+    std::vector<uint64_t> bits;
+    std::unordered_set<std::string> other_hashes;
+    index.get_reachable(root_commits, root_objects, bits, other_hashes);
+
+    const std::vector<std::string> object_hashes = list_loose_objects();
+    std::uintmax_t total_size = 0;
+    std::size_t reachable_count = 0;
+
+    for(const std::string& object_hash : object_hashes) {
+        total_size += fs::file_size(utils::get_object_path(object_hash));
+        if(index.contains(bits, object_hash) || other_hashes.count(object_hash)) { ++reachable_count; }
+    }
+
+    utils::write(utils::INFO, "count:", std::to_string(object_hashes.size()));
+    utils::write(utils::INFO, "size:", std::to_string((total_size + 1023) / 1024), "KiB");
+    utils::write(utils::INFO, "reachable:", std::to_string(reachable_count));
+    utils::write(utils::INFO, "unreachable:", std::to_string(object_hashes.size() - reachable_count));
+    utils::write(utils::INFO, "bitmaps:", std::to_string(index.bitmap_count()), "over", std::to_string(index.size()), "objects");
+}
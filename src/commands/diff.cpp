@@ -15,19 +15,44 @@ void DiffCommand::help()
     utils::write(utils::INFO, "usage: vcs diff");                       //  (Staging Area to Working Directory) -> this will not show the new files only modified and deleted files only 
     utils::write(utils::INFO, "usage: vcs diff --staged");              //  (Staging Area vs Last Commit)
     utils::write(utils::INFO, "usage: vcs diff --cached");              //  (Staging Area vs Last Commit)
-    // utils::write(utils::INFO, "usage: vcs diff <commit1>");             //  commit to current working directory
+    utils::write(utils::INFO, "usage: vcs diff <commit1>");             //  (Commit1 vs Working Directory)
     utils::write(utils::INFO, "usage: vcs diff <branch1> <branch2>");   //  (Branch1 vs Branch2)
     utils::write(utils::INFO, "usage: vcs diff <commit1> <commit2>");   //  (Commit1 vs Commit2)
+    utils::write(utils::INFO, "flag : --stat        (changed files with added/deleted line counts)");
+    utils::write(utils::INFO, "flag : --name-only   (names of changed files only)");
+    utils::write(utils::INFO, "flag : --name-status (names of changed files with their status)");
+    utils::write(utils::INFO, "flag : --word-diff   (changed lines compared word by word)");
     utils::write(utils::EMPTY);
 }
 
 void DiffCommand::validate(std::vector<std::string>& args) {
+    // Summary and word diff flags can be combined with every form, so strip them before checking the rest
+    for (auto it = args.begin(); it != args.end(); ) {
+        DiffFormat flag_format = DiffFormat::PATCH;
+
+        if(*it == "--word-diff") { this->word_diff = true; it = args.erase(it); continue; }
+        else if(*it == "--stat") { flag_format = DiffFormat::STAT; }
+        else if(*it == "--name-only") { flag_format = DiffFormat::NAME_ONLY; }
+        else if(*it == "--name-status") { flag_format = DiffFormat::NAME_STATUS; }
+        else { ++it; continue; }
+
+        if(this->format != DiffFormat::PATCH) {
+            const std::string error_msg = "Only one of '--stat', '--name-only' or '--name-status' can be used";
+            throw std::invalid_argument(error_msg);
+        }
+
+        this->format = flag_format;
+        it = args.erase(it);
+    }
+
     int args_size = args.size();
 
     if(args_size == 0);
     else if(args_size == 1) {
         if(args[0] == "--staged" || args[0] == "--cached") { return; }
 
+        if(fs::exists(config::REFS_HEAD_DIR + args[0])) { return; }
+
         const std::string& commit_hash = args[0];
 
         if(CatFileCommand().get_object_type(commit_hash) != "commit") {
@@ -75,7 +100,7 @@ void get_index_files(std::map<std::string, std::pair<std::string, std::string>>&
     }
 }
 
-void solve(const std::string& tree_hash, std::string path, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files) {
+void solve(const std::string& tree_hash, std::string path, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, const std::map<std::string, std::pair<std::string, std::string>>& index_files) {
     const std::string tree_content = utils::read_and_decompress(utils::get_object_path(tree_hash));
 
     // ./main.out ls-tree 6725736609ced67ff91c01194131fb5c1e96b795
@@ -98,7 +123,13 @@ void solve(const std::string& tree_hash, std::string path, std::map<std::string,
         iss >> mode >> type >> hash >> mtime >> size >> file_name;
 
         if (type == "tree") {
-            solve(hash, file_name + "/", last_commit_files); // Recursive call for sub-trees
+            // A directory the sparse index has as one entry is compared as one entry while it's unchanged
+            auto it = index_files.find(path + file_name + "/");
+            if (it != index_files.end() && it->second.second == hash) {
+                last_commit_files[it->first] = it->second;
+                continue;
+            }
+            solve(hash, path + file_name + "/", last_commit_files, index_files); // Recursive call for sub-trees
         } else if (type == "blob") {
             const std::string filepath = path + file_name;
             last_commit_files[filepath] = {mode, hash}; 
@@ -106,14 +137,77 @@ void solve(const std::string& tree_hash, std::string path, std::map<std::string,
     }
 }
 
-void get_last_commit_files(std::map<std::string, std::pair<std::string, std::string>>& last_commit_files) {
+void get_last_commit_files(std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, std::map<std::string, std::pair<std::string, std::string>>& index_files) {
     const std::string head_commit_hash = utils::get_head_commit_hash();
     const std::string tree_hash = utils::get_tree_hash_from_commit(head_commit_hash);
 
-    solve(tree_hash, "", last_commit_files);
+    solve(tree_hash, "", last_commit_files, index_files);
+
+    // Directory entries that don't match the commit are compared file by file
+    for(auto it = index_files.begin(); it != index_files.end();) {
+        if(it->second.first != "040000" || last_commit_files.count(it->first)) {
+            ++it;
+            continue;
+        }
+
+        std::stringstream buffer;
+        utils::solve(it->second.second, buffer, it->first);
+        it = index_files.erase(it);
+
+        std::string line;
+        while(std::getline(buffer, line)) {
+            std::istringstream line_stream(line);
+            std::string file_path, blob_hash, size, mode;
+            if(line_stream >> file_path >> blob_hash >> size >> mode) { index_files.emplace(file_path, std::make_pair(mode, blob_hash)); }
+        }
+    }
+}
+
+using FileDiff = std::vector<std::string>; // formatted output lines of a single file
+
+void print_file_diff(size_t, FileDiff& file_diff) {
+    for (const std::string& line : file_diff) {
+        std::cout << line << '\n';
+    }
+}
+
+size_t get_lines_bytes(const std::vector<std::string>& lines) {
+    size_t bytes = 0;
+    for (const std::string& line : lines) {
+        bytes += sizeof(std::string) + line.size();
+    }
+    return bytes;
+}
+
+std::string get_word_diff_line(const std::string& old_line, const std::string& new_line) {
+    const std::vector<std::string> old_tokens = diff_engine::tokenize_words(old_line);
+    const std::vector<std::string> new_tokens = diff_engine::tokenize_words(new_line);
+    const std::vector<char> script = diff_engine::get_edit_script(old_tokens, new_tokens, config::WORD_DIFF_MAX_EDITS);
+
+    if (script.empty()) { return ""; }
+
+    std::string line, deleted, added;
+    size_t i = 0, j = 0;
+
+    // Adjacent deleted and added tokens are printed as one [-deleted-]{+added+} group
+    auto flush = [&]() {
+        if (!deleted.empty()) { line += utils::get_red_text("[-" + deleted + "-]"); }
+        if (!added.empty()) { line += utils::get_light_green_text("{+" + added + "+}"); }
+        deleted.clear();
+        added.clear();
+    };
+
+    for (char op : script) {
+        if (op == '=') { flush(); line += old_tokens[i++]; ++j; }
+        else if (op == '-') { deleted += old_tokens[i++]; }
+        else { added += new_tokens[j++]; }
+    }
+    flush();
+
+    return line;
 }
 
-void show_line_diff(const std::vector<std::string>& old_lines, const std::vector<std::string>& new_lines) {
+void show_line_diff(const std::vector<std::string>& old_lines, const std::vector<std::string>& new_lines, FileDiff& file_diff, const bool word_diff) {
     int n = old_lines.size();
     int m = new_lines.size();
 
@@ -135,34 +229,25 @@ void show_line_diff(const std::vector<std::string>& old_lines, const std::vector
     int add_count = 0;
     int mx_size_int = std::max(std::to_string(n).size(), std::to_string(m).size());
 
+    // {old_line_number, new_line_number}, 0 on the side the line is missing from
+    std::vector<std::pair<int, int>> edits;
+
     // Backtrack to get the diff output
     int i = n, j = m;
-    std::vector<std::string> output;
 
     while (i > 0 && j > 0) {
-        std::string old_str = std::to_string(i);
-        std::string new_str = std::to_string(j);
-
-        std::string old_empty = std::string(mx_size_int - (int)old_str.size(), ' ');
-        std::string new_empty = std::string(mx_size_int - (int)new_str.size(), ' ');
-
-        old_str = "-" + old_str + old_empty;
-        new_str = "+" + new_str + new_empty;
-
         if (old_lines[i - 1] == new_lines[j - 1]) {
             // Lines are the same, no diff needed
-            output.push_back(old_str + " " + new_str + " |   " + old_lines[i - 1]);
+            edits.push_back({i, j});
             --i; --j;
         } else if (dp[i - 1][j] >= dp[i][j - 1]) {
             // Line removed from old_lines
-            const std::string old_line = old_str + "  " + std::string(mx_size_int, '#') + " | - " + old_lines[i - 1];
-            output.push_back(utils::get_red_text(old_line));
+            edits.push_back({i, 0});
             --i;
             ++delete_count;
         } else {
             // Line added in new_lines 
-            const std::string new_line = " " + std::string(mx_size_int, '#') + " " + new_str + " | + " + new_lines[j - 1];
-            output.push_back(utils::get_light_green_text(new_line));
+            edits.push_back({0, j});
             --j;
             ++add_count;
         }
@@ -170,170 +255,607 @@ void show_line_diff(const std::vector<std::string>& old_lines, const std::vector
 
     // Remaining lines in old_lines are deletions
     while (i > 0) {
-        std::string old_str = std::to_string(i);
-        std::string old_empty = std::string(mx_size_int - (int)old_str.size(), ' ');
-        old_str = "-" + old_str + old_empty;
-
-        const std::string old_line = old_str + "  " + std::string(mx_size_int, '#') + " | - " + old_lines[i - 1];
-        output.push_back(utils::get_red_text(old_line));
+        edits.push_back({i, 0});
         --i;
         ++delete_count;
     }
 
     // Remaining lines in new_lines are additions
     while (j > 0) {
-        std::string new_str = std::to_string(j);
-        std::string new_empty = std::string(mx_size_int - (int)new_str.size(), ' ');
-        new_str = "+" + new_str + new_empty;
-
-        const std::string new_line = " " + std::string(mx_size_int, '#') + " " + new_str + " | + " + new_lines[j - 1];
-        output.push_back(utils::get_light_green_text(new_line));
+        edits.push_back({0, j});
         --j;
         ++add_count;
     }
 
     // Reverse to get correct order
-    std::reverse(output.begin(), output.end());
+    std::reverse(edits.begin(), edits.end());
+
+    auto get_number = [&](char sign, int number) {
+        const std::string str = std::to_string(number);
+        return sign + str + std::string(mx_size_int - (int)str.size(), ' ');
+    };
+
+    auto deleted_line = [&](int old_number) {
+        return utils::get_red_text(get_number('-', old_number) + "  " + std::string(mx_size_int, '#') + " | - " + old_lines[old_number - 1]);
+    };
+
+    auto added_line = [&](int new_number) {
+        return utils::get_light_green_text(" " + std::string(mx_size_int, '#') + " " + get_number('+', new_number) + " | + " + new_lines[new_number - 1]);
+    };
 
-    utils::write(utils::INFO, "lines:", "-" + std::to_string(delete_count), "+" + std::to_string(add_count));
+    std::vector<std::string> output;
+
+    for (size_t k = 0; k < edits.size(); ) {
+        const auto& [old_number, new_number] = edits[k];
+
+        if (old_number && new_number) {
+            output.push_back(get_number('-', old_number) + " " + get_number('+', new_number) + " |   " + old_lines[old_number - 1]);
+            ++k;
+            continue;
+        }
+
+        if (!word_diff) {
+            output.push_back(old_number ? deleted_line(old_number) : added_line(new_number));
+            ++k;
+            continue;
+        }
+
+        // A run of changed lines, the i-th deleted line is compared word by word with the i-th added line
+        std::vector<int> deleted, added;
+        for (; k < edits.size() && !(edits[k].first && edits[k].second); ++k) {
+            if (edits[k].first) deleted.push_back(edits[k].first);
+            else added.push_back(edits[k].second);
+        }
+
+        const size_t paired = std::min(deleted.size(), added.size());
+        for (size_t p = 0; p < paired; ++p) {
+            const std::string word_line = get_word_diff_line(old_lines[deleted[p] - 1], new_lines[added[p] - 1]);
+            if (word_line.empty()) {
+                output.push_back(deleted_line(deleted[p]));
+                output.push_back(added_line(added[p]));
+                continue;
+            }
+            output.push_back(get_number('-', deleted[p]) + " " + get_number('+', added[p]) + " | ~ " + word_line);
+        }
+        for (size_t p = paired; p < deleted.size(); ++p) output.push_back(deleted_line(deleted[p]));
+        for (size_t p = paired; p < added.size(); ++p) output.push_back(added_line(added[p]));
+    }
+
+    file_diff.push_back(utils::format(utils::INFO, "lines:", "-" + std::to_string(delete_count), "+" + std::to_string(add_count)));
     
-    // Print the diff lines
+    // Collect the diff lines
     for (const std::string& line : output) {
-        utils::write(utils::CONTENT, line);
+        file_diff.push_back(utils::format(utils::CONTENT, line));
+    }
+}
+
+void show_line_diff(const std::vector<std::string>& old_lines, const std::vector<std::string>& new_lines, FileDiff& file_diff, const bool word_diff, OrderedTaskPool<FileDiff>& pool, size_t index) {
+    // The LCS table dominates, the formatted output stays reserved until it is printed
+    const size_t dp_bytes = (old_lines.size() + 1) * (sizeof(std::vector<int>) + (new_lines.size() + 1) * sizeof(int));
+    const size_t output_bytes = 2 * (get_lines_bytes(old_lines) + get_lines_bytes(new_lines));
+
+    pool.reserve(index, dp_bytes + output_bytes);
+    show_line_diff(old_lines, new_lines, file_diff, word_diff);
+    pool.release(index, dp_bytes);
+}
+
+FileDiff worktree_file_diff(const std::string& filepath, const std::string& mode, const std::string& old_hash, const std::string& new_file_mode, const std::string& new_hash, const bool word_diff, OrderedTaskPool<FileDiff>& pool, size_t index) {
+    FileDiff file_diff;
+
+    if (mode != new_file_mode) {
+        file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, old_hash));
+        file_diff.push_back(utils::format(utils::INFO, "old mode:", mode));
+        file_diff.push_back(utils::format(utils::INFO, "new mode:", new_file_mode));
+        if(old_hash == new_hash) { file_diff.push_back(utils::format(utils::EMPTY)); }
+    }
+
+    if(old_hash == new_hash) { return file_diff; }
+
+    std::vector<std::string> new_lines, old_lines;
+    utils::get_lines_from_file(filepath, new_lines);
+    utils::get_lines_from_blob(old_hash, old_lines);
+
+    if(mode == new_file_mode) file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, mode));
+    file_diff.push_back(utils::format(utils::INFO, "---", "a/" + filepath));
+    file_diff.push_back(utils::format(utils::INFO, "+++", "b/" + filepath));
+    show_line_diff(old_lines, new_lines, file_diff, word_diff, pool, index);
+    file_diff.push_back(utils::format(utils::EMPTY));
+
+    return file_diff;
+}
+
+FileDiff worktree_file_diff(const std::string& filepath, const std::string& mode, const std::string& old_hash, const bool word_diff, OrderedTaskPool<FileDiff>& pool, size_t index) {
+    if (!fs::exists(filepath)) {
+        FileDiff file_diff;
+        file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, old_hash, mode));
+        file_diff.push_back(utils::format(utils::INFO, "deleted:", filepath));
+        file_diff.push_back(utils::format(utils::EMPTY));
+        return file_diff;
     }
+
+    const std::string new_hash = utils::sha1(utils::read_file_content(filepath)); 
+
+    const std::string new_file_mode = utils::get_file_mode(filepath);
+
+    return worktree_file_diff(filepath, mode, old_hash, new_file_mode, new_hash, word_diff, pool, index);
+}
+
+void print_diff(std::map<std::string, std::pair<std::string, std::string>>& index_files, const bool word_diff) {
+    utils::write(utils::OK);
+    utils::write(utils::EMPTY);
+
+    // {file_path, {mode, blob_hash}} in path order, files are diffed in parallel and printed in this order. Skip-worktree
+    // files aren't in the working directory and are left out.
+    const SparseCheckout sparse;
+    std::vector<std::pair<std::string, std::pair<std::string, std::string>>> files;
+    for(const auto& file : index_files) {
+        if(!sparse.is_skip_worktree(file.first)) { files.push_back(file); }
+    }
+
+    OrderedTaskPool<FileDiff> pool(files.size());
+    pool.run(
+        [&](size_t index) { return worktree_file_diff(files[index].first, files[index].second.first, files[index].second.second, word_diff, pool, index); },
+        print_file_diff
+    );
+}
+
+struct TreeFileDiffTask {
+    std::string filepath;
+    const std::pair<std::string, std::string>* new_file; // {mode, blob_hash}, nullptr when deleted
+    const std::pair<std::string, std::string>* old_file; // {mode, blob_hash}, nullptr when added
+    const RenameMatch* rename;                           // set when the file is a rename or copy of another path
+};
+
+FileDiff renamed_file_diff(const TreeFileDiffTask& task, const bool word_diff, OrderedTaskPool<FileDiff>& pool, size_t index) {
+    FileDiff file_diff;
+    const RenameMatch& rename = *task.rename;
+
+    file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + rename.old_path, "b/" + rename.new_path));
+    file_diff.push_back(utils::format(utils::INFO, "similarity:", std::to_string(rename.similarity) + "%"));
+    file_diff.push_back(utils::format(utils::INFO, rename.is_copy ? "copied:" : "renamed:", rename.old_path, "->", rename.new_path));
+
+    if(task.old_file->first != task.new_file->first) {
+        file_diff.push_back(utils::format(utils::INFO, "old mode:", task.old_file->first));
+        file_diff.push_back(utils::format(utils::INFO, "new mode:", task.new_file->first));
+    }
+
+    if(task.old_file->second != task.new_file->second) {
+        std::vector<std::string> new_lines, old_lines;
+        utils::get_lines_from_blob(task.new_file->second, new_lines);
+        utils::get_lines_from_blob(task.old_file->second, old_lines);
+
+        file_diff.push_back(utils::format(utils::INFO, "---", "a/" + rename.old_path));
+        file_diff.push_back(utils::format(utils::INFO, "+++", "b/" + rename.new_path));
+        show_line_diff(old_lines, new_lines, file_diff, word_diff, pool, index);
+    }
+
+    file_diff.push_back(utils::format(utils::EMPTY));
+    return file_diff;
+}
+
+FileDiff tree_file_diff(const TreeFileDiffTask& task, const bool word_diff, OrderedTaskPool<FileDiff>& pool, size_t index) {
+    if(task.rename != nullptr) { return renamed_file_diff(task, word_diff, pool, index); }
+
+    FileDiff file_diff;
+    const std::string& filepath = task.filepath;
+
+    if(task.new_file == nullptr) {
+        const std::string& commit_old_file_mode = task.old_file->first;
+        const std::string& commit_old_file_hash = task.old_file->second;
+
+        file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, commit_old_file_hash, commit_old_file_mode));
+        file_diff.push_back(utils::format(utils::INFO, "deleted file:", filepath));
+        file_diff.push_back(utils::format(utils::EMPTY));
+        return file_diff;
+    }
+
+    const std::string& index_new_file_mode = task.new_file->first;
+    const std::string& index_new_file_hash = task.new_file->second;
+
+    if(task.old_file == nullptr) {
+        file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, index_new_file_hash, index_new_file_mode));
+        file_diff.push_back(utils::format(utils::INFO, "new file:", filepath));
+        file_diff.push_back(utils::format(utils::EMPTY));
+        return file_diff;
+    }
+
+    const std::string& commit_old_file_mode = task.old_file->first;
+    const std::string& commit_old_file_hash = task.old_file->second;
+
+    const std::string old_str = ((commit_old_file_mode == index_new_file_mode) ? "" : commit_old_file_mode + " ") + ((index_new_file_hash == commit_old_file_hash) ? "" : commit_old_file_hash);
+    const std::string new_str = ((commit_old_file_mode == index_new_file_mode) ? "" : index_new_file_mode + " ") + ((index_new_file_hash == commit_old_file_hash) ? "" : index_new_file_hash);
+    const std::string str = ((index_new_file_hash == commit_old_file_hash) ? index_new_file_hash + " " : "") + ((commit_old_file_mode == index_new_file_mode) ? commit_old_file_mode : "");
+
+    if(index_new_file_mode != commit_old_file_mode) {
+        file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, str));
+        file_diff.push_back(utils::format(utils::INFO, "old:", old_str));
+        file_diff.push_back(utils::format(utils::INFO, "new:", new_str));
+        if(index_new_file_hash == commit_old_file_hash) { file_diff.push_back(utils::format(utils::EMPTY)); }
+    }
+
+    if(index_new_file_hash == commit_old_file_hash) { return file_diff; }
+
+    std::vector<std::string> new_lines, old_lines;
+    utils::get_lines_from_blob(index_new_file_hash, new_lines);
+    utils::get_lines_from_blob(commit_old_file_hash, old_lines);
+
+    if(index_new_file_mode == commit_old_file_mode) file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, str));
+    if(index_new_file_mode == commit_old_file_mode) file_diff.push_back(utils::format(utils::INFO, "old:", old_str));
+    if(index_new_file_mode == commit_old_file_mode) file_diff.push_back(utils::format(utils::INFO, "new:", new_str));
+    file_diff.push_back(utils::format(utils::INFO, "---", "a/" + filepath));
+    file_diff.push_back(utils::format(utils::INFO, "+++", "b/" + filepath));
+    show_line_diff(old_lines, new_lines, file_diff, word_diff, pool, index);
+    file_diff.push_back(utils::format(utils::EMPTY));
+
+    return file_diff;
 }
 
-void print_diff(std::map<std::string, std::pair<std::string, std::string>>& index_files) {
+void compare_diffs(std::map<std::string, std::pair<std::string, std::string>>& index_files, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, const bool word_diff) {
     utils::write(utils::OK);
     utils::write(utils::EMPTY);
-    // for(const auto& [filepath, old_hash] : index_files) {
-    for(const std::pair<std::string, std::pair<std::string, std::string>>& p : index_files) {
-        const std::string& filepath = p.first;
-        const std::string& mode = p.second.first; // mode
-        const std::string& old_hash = p.second.second; // blob_hash
-
-        if (!fs::exists(filepath)) {
-            utils::write(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, old_hash, mode);
-            utils::write(utils::INFO, "deleted:", filepath);
-            utils::write(utils::EMPTY);
+
+    std::map<std::string, std::pair<std::string, std::string>> deleted_files, added_files, modified_files;
+    diff_engine::split_changes(last_commit_files, index_files, deleted_files, added_files, modified_files);
+
+    const std::vector<RenameMatch> renames = diff_engine::detect_renames(deleted_files, added_files, modified_files);
+
+    std::map<std::string, const RenameMatch*> rename_of_target;
+    std::set<std::string> renamed_sources;
+    for(const RenameMatch& rename : renames) {
+        rename_of_target[rename.new_path] = &rename;
+        if(!rename.is_copy) { renamed_sources.insert(rename.old_path); }
+    }
+
+    // New and modified files in path order first, then the deleted ones
+    std::vector<TreeFileDiffTask> tasks;
+
+    for(const auto& [filepath, new_file] : index_files) {
+        auto rename = rename_of_target.find(filepath);
+        if(rename != rename_of_target.end()) {
+            tasks.push_back({filepath, &new_file, &last_commit_files.at(rename->second->old_path), rename->second});
             continue;
         }
 
-        const std::string new_hash = utils::sha1(utils::read_file_content(filepath)); 
+        auto it = last_commit_files.find(filepath);
+        tasks.push_back({filepath, &new_file, (it == last_commit_files.end()) ? nullptr : &it->second, nullptr});
+    }
+
+    for(const auto& [filepath, old_file] : last_commit_files) {
+        if(index_files.find(filepath) == index_files.end() && renamed_sources.count(filepath) == 0) {
+            tasks.push_back({filepath, nullptr, &old_file, nullptr});
+        }
+    }
+
+    OrderedTaskPool<FileDiff> pool(tasks.size());
+    pool.run(
+        [&](size_t index) { return tree_file_diff(tasks[index], word_diff, pool, index); },
+        print_file_diff
+    );
+}
+
+void collect_worktree_changes(std::vector<DiffEntry>& entries, const bool need_hash) {
+    std::map<std::string, IndexEntry> index_entries;
+    utils::read_index(index_entries);
+
+    // Entries written in the same second as the index can't be trusted by mtime alone (racy entries)
+    const std::time_t index_mtime = utils::is_file_exist(config::INDEX_FILE) ? utils::get_mtime(config::INDEX_FILE) : 0;
+    const SparseCheckout sparse;
+
+    for(const auto& [filepath, entry] : index_entries) {
+        if(sparse.is_skip_worktree(filepath)) { continue; } // not in the working directory, taken to match the index
+
+        if(!fs::exists(filepath)) {
+            entries.push_back({'D', filepath, entry.mode, entry.hash, "", ""});
+            continue;
+        }
 
         const std::string new_file_mode = utils::get_file_mode(filepath);
+        const std::string new_file_size = std::to_string(utils::get_file_size(filepath));
+        const bool is_same_mode = (new_file_mode == entry.mode);
+
+        // Unchanged stat data means unchanged content, no need to read the file
+        if(is_same_mode && new_file_size == entry.size && utils::get_mtime(filepath) == entry.mtime && entry.mtime < index_mtime) { continue; }
 
-        if (mode != new_file_mode) {
-            utils::write(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, old_hash);
-            utils::write(utils::INFO, "old mode:", mode);
-            utils::write(utils::INFO, "new mode:", new_file_mode);
-            if(old_hash == new_hash) { utils::write(utils::EMPTY); }
+        // A different size is already a modification, hash only when the caller needs it
+        if(!need_hash && new_file_size != entry.size) {
+            entries.push_back({'M', filepath, entry.mode, entry.hash, new_file_mode, ""});
+            continue;
         }
 
-        if(old_hash == new_hash) { continue; }
+        const std::string new_hash = utils::sha1(utils::read_file_content(filepath));
+        if(is_same_mode && new_hash == entry.hash) { continue; }
 
-        std::vector<std::string> new_lines, old_lines;
-        utils::get_lines_from_file(filepath, new_lines);
-        utils::get_lines_from_blob(old_hash, old_lines);
+        entries.push_back({'M', filepath, entry.mode, entry.hash, new_file_mode, new_hash});
+    }
+}
 
-        if(mode == new_file_mode) utils::write(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, mode);
-        utils::write(utils::INFO, "---", "a/" + filepath);
-        utils::write(utils::INFO, "+++", "b/" + filepath);
-        show_line_diff(old_lines, new_lines);
-        utils::write(utils::EMPTY);
+struct CommitWorktreeWalk {
+    std::map<std::string, IndexEntry> index_entries;
+    std::time_t index_mtime;
+    std::time_t commit_time;
+    bool need_hash;
+    std::set<std::string> commit_paths;
+    SparseCheckout sparse;
+};
+
+// Stat data of the working directory file matches the recorded entry, written before 'written_time' so not racy
+bool is_stat_clean(const std::string& mode, const std::string& size, std::time_t mtime, const std::string& entry_mode, const std::string& entry_size, std::time_t entry_mtime, std::time_t written_time) {
+    return mode == entry_mode && size == entry_size && mtime == entry_mtime && entry_mtime < written_time;
+}
+
+// Reads the commit tree one object at a time, a file is only read when neither the commit entry
+// nor an index entry of the same blob vouches for it by stat data
+void walk_commit_tree(const std::string& tree_hash, const std::string& path, CommitWorktreeWalk& walk, std::vector<DiffEntry>& entries) {
+    for(const TreeEntry& tree_entry : utils::read_tree(tree_hash)) {
+        const std::string filepath = path + tree_entry.name;
+
+        if(tree_entry.type == "tree") {
+            // Nothing under a directory outside the sparse checkout is in the working directory
+            if(!walk.sparse.is_outside(filepath)) { walk_commit_tree(tree_entry.hash, filepath + "/", walk, entries); }
+            continue;
+        }
+
+        walk.commit_paths.insert(filepath);
+        if(walk.sparse.is_skip_worktree(filepath)) { continue; }
+
+        if(!fs::is_regular_file(filepath)) {
+            entries.push_back({'D', filepath, tree_entry.mode, tree_entry.hash, "", ""});
+            continue;
+        }
+
+        const std::string new_file_mode = utils::get_file_mode(filepath);
+        const std::string new_file_size = std::to_string(utils::get_file_size(filepath));
+        const std::time_t new_file_mtime = utils::get_mtime(filepath);
+
+        if(is_stat_clean(new_file_mode, new_file_size, new_file_mtime, tree_entry.mode, tree_entry.size, tree_entry.mtime, walk.commit_time)) { continue; }
+
+        auto it = walk.index_entries.find(filepath);
+        if(it != walk.index_entries.end() && it->second.hash == tree_entry.hash) {
+            const IndexEntry& index_entry = it->second;
+            if(is_stat_clean(new_file_mode, new_file_size, new_file_mtime, index_entry.mode, index_entry.size, index_entry.mtime, walk.index_mtime)) { continue; }
+        }
+
+        // A different size is already a modification, hash only when the caller needs it
+        if(!walk.need_hash && new_file_size != tree_entry.size) {
+            entries.push_back({'M', filepath, tree_entry.mode, tree_entry.hash, new_file_mode, ""});
+            continue;
+        }
+
+        const std::string new_hash = utils::sha1(utils::read_file_content(filepath));
+        if(new_file_mode == tree_entry.mode && new_hash == tree_entry.hash) { continue; }
+
+        entries.push_back({'M', filepath, tree_entry.mode, tree_entry.hash, new_file_mode, new_hash});
     }
 }
 
-void compare_diffs(std::map<std::string, std::pair<std::string, std::string>>& index_files, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files) {
+void collect_commit_worktree_changes(const std::string& commit_hash, std::vector<DiffEntry>& entries, const bool need_hash) {
+    CommitWorktreeWalk walk;
+    utils::read_index(walk.index_entries);
+    walk.index_mtime = utils::is_file_exist(config::INDEX_FILE) ? utils::get_mtime(config::INDEX_FILE) : 0;
+    walk.commit_time = utils::get_commit_timestamp(commit_hash);
+    walk.need_hash = need_hash;
+
+    const std::string tree_hash = utils::get_tree_hash_from_commit(commit_hash);
+    if(!tree_hash.empty()) { walk_commit_tree(tree_hash, "", walk, entries); }
+
+    // Tracked files the commit doesn't have
+    for(const auto& [filepath, index_entry] : walk.index_entries) {
+        if(walk.commit_paths.count(filepath) || walk.sparse.is_skip_worktree(filepath) || !fs::is_regular_file(filepath)) { continue; }
+
+        const std::string new_hash = need_hash ? utils::sha1(utils::read_file_content(filepath)) : "";
+        entries.push_back({'A', filepath, "", "", utils::get_file_mode(filepath), new_hash});
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const DiffEntry& a, const DiffEntry& b) { return a.filepath < b.filepath; });
+}
+
+FileDiff commit_worktree_file_diff(const DiffEntry& entry, const bool word_diff, OrderedTaskPool<FileDiff>& pool, size_t index) {
+    FileDiff file_diff;
+    const std::string& filepath = entry.filepath;
+
+    if(entry.status == 'D') {
+        file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, entry.old_hash, entry.old_mode));
+        file_diff.push_back(utils::format(utils::INFO, "deleted:", filepath));
+        file_diff.push_back(utils::format(utils::EMPTY));
+        return file_diff;
+    }
+
+    if(entry.status == 'A') {
+        file_diff.push_back(utils::format(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, entry.new_hash, entry.new_mode));
+        file_diff.push_back(utils::format(utils::INFO, "new file:", filepath));
+        file_diff.push_back(utils::format(utils::EMPTY));
+        return file_diff;
+    }
+
+    return worktree_file_diff(filepath, entry.old_mode, entry.old_hash, entry.new_mode, entry.new_hash, word_diff, pool, index);
+}
+
+void print_commit_worktree_diff(const std::vector<DiffEntry>& entries, const bool word_diff) {
     utils::write(utils::OK);
     utils::write(utils::EMPTY);
 
-    for(const std::pair<std::string, std::pair<std::string, std::string>>& p : index_files) {
-        const std::string& filepath = p.first;
-        const std::string& index_new_file_mode = p.second.first; // mode
-        const std::string& index_new_file_hash = p.second.second; // blob_hash
+    OrderedTaskPool<FileDiff> pool(entries.size());
+    pool.run(
+        [&](size_t index) { return commit_worktree_file_diff(entries[index], word_diff, pool, index); },
+        print_file_diff
+    );
+}
 
-        auto it = last_commit_files.find(filepath);
-        
-        if(it == last_commit_files.end()) {
-            utils::write(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, index_new_file_hash, index_new_file_mode);
-            utils::write(utils::INFO, "new file:", filepath);
-            utils::write(utils::EMPTY);
-            continue;
+void collect_tree_changes(const std::map<std::string, std::pair<std::string, std::string>>& new_files, const std::map<std::string, std::pair<std::string, std::string>>& old_files, const DiffFormat format, std::vector<DiffEntry>& entries) {
+    std::map<std::string, std::pair<std::string, std::string>> deleted_files, added_files, modified_files;
+    diff_engine::split_changes(old_files, new_files, deleted_files, added_files, modified_files);
+
+    // --name-only never reads a blob, only renames with identical content are paired there. The other formats
+    // read the blobs of unpaired deleted and added files to find inexact renames.
+    std::map<std::string, const RenameMatch*> rename_of_target;
+    std::set<std::string> renamed_sources;
+    const std::vector<RenameMatch> renames = diff_engine::detect_renames(deleted_files, added_files, modified_files, format == DiffFormat::NAME_ONLY);
+    for(const RenameMatch& rename : renames) {
+        rename_of_target[rename.new_path] = &rename;
+        if(!rename.is_copy) { renamed_sources.insert(rename.old_path); }
+    }
+
+    for(const auto& [filepath, new_file] : new_files) {
+        auto it = old_files.find(filepath);
+        auto rename = rename_of_target.find(filepath);
+
+        if(rename != rename_of_target.end()) {
+            const std::pair<std::string, std::string>& old_file = old_files.at(rename->second->old_path);
+            entries.push_back({rename->second->is_copy ? 'C' : 'R', filepath, old_file.first, old_file.second, new_file.first, new_file.second, rename->second->old_path, rename->second->similarity});
+        }
+        else if(it == old_files.end()) {
+            entries.push_back({'A', filepath, "", "", new_file.first, new_file.second});
+        }
+        else if(it->second != new_file) {
+            entries.push_back({'M', filepath, it->second.first, it->second.second, new_file.first, new_file.second});
         }
+    }
 
-        const std::string commit_old_file_mode = it->second.first;
-        const std::string commit_old_file_hash = it->second.second;
+    for(const auto& [filepath, old_file] : old_files) {
+        if(new_files.find(filepath) == new_files.end() && renamed_sources.count(filepath) == 0) {
+            entries.push_back({'D', filepath, old_file.first, old_file.second, "", ""});
+        }
+    }
 
-        const std::string old_str = ((commit_old_file_mode == index_new_file_mode) ? "" : commit_old_file_mode + " ") + ((index_new_file_hash == commit_old_file_hash) ? "" : commit_old_file_hash);
-        const std::string new_str = ((commit_old_file_mode == index_new_file_mode) ? "" : index_new_file_mode + " ") + ((index_new_file_hash == commit_old_file_hash) ? "" : index_new_file_hash);
-        const std::string str = ((index_new_file_hash == commit_old_file_hash) ? index_new_file_hash + " " : "") + ((commit_old_file_mode == index_new_file_mode) ? commit_old_file_mode : "");
+    std::sort(entries.begin(), entries.end(), [](const DiffEntry& a, const DiffEntry& b) { return a.filepath < b.filepath; });
+}
+
+std::pair<int, int> count_entry_changes(const DiffEntry& entry, const bool is_worktree) {
+    // Mode only change or exact rename, content is the same and no blob is read
+    if(!entry.new_hash.empty() && entry.old_hash == entry.new_hash) { return {0, 0}; }
+
+    std::vector<std::string> old_lines, new_lines;
+
+    if(entry.status != 'A') { utils::get_lines_from_blob(entry.old_hash, old_lines); }
+
+    if(entry.status != 'D') {
+        if(is_worktree) { utils::get_lines_from_file(entry.filepath, new_lines); }
+        else { utils::get_lines_from_blob(entry.new_hash, new_lines); }
+    }
 
-        if(index_new_file_mode != commit_old_file_mode) {
-            utils::write(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, str);
-            utils::write(utils::INFO, "old:", old_str);
-            utils::write(utils::INFO, "new:", new_str);
-            if(index_new_file_hash == commit_old_file_hash) { utils::write(utils::EMPTY); }
+    return diff_engine::count_line_changes(old_lines, new_lines);
+}
+
+void DiffCommand::print_summary(const std::vector<DiffEntry>& entries, const bool is_worktree) {
+    utils::write(utils::OK);
+    utils::write(utils::EMPTY);
+
+    if(this->format == DiffFormat::NAME_ONLY) {
+        for(const DiffEntry& entry : entries) {
+            utils::write(utils::INFO, entry.filepath);
+        }
+    }
+    else if(this->format == DiffFormat::NAME_STATUS) {
+        for(const DiffEntry& entry : entries) {
+            if(entry.status == 'A') utils::write(utils::NEW_FILE, utils::get_light_green_text(entry.filepath));
+            else if(entry.status == 'D') utils::write(utils::DELETED, utils::get_red_text(entry.filepath));
+            else if(entry.status == 'R') utils::write(utils::RENAMED, entry.old_filepath, "->", entry.filepath, "(" + std::to_string(entry.similarity) + "%)");
+            else if(entry.status == 'C') utils::write(utils::COPIED, entry.old_filepath, "->", entry.filepath, "(" + std::to_string(entry.similarity) + "%)");
+            else utils::write(utils::MODIFIED, entry.filepath);
+        }
+    }
+    else {
+        const int max_bar_width = 40;
+        std::vector<std::pair<int, int>> counts;
+        size_t max_path_size = 0;
+        int max_changes = 0, total_deleted = 0, total_added = 0;
+
+        std::vector<std::string> names;
+
+        for(const DiffEntry& entry : entries) {
+            counts.push_back(count_entry_changes(entry, is_worktree));
+            names.push_back(entry.old_filepath.empty() ? entry.filepath : entry.old_filepath + " => " + entry.filepath);
+            max_path_size = std::max(max_path_size, names.back().size());
+            max_changes = std::max(max_changes, counts.back().first + counts.back().second);
+            total_deleted += counts.back().first;
+            total_added += counts.back().second;
         }
 
-        if(index_new_file_hash == commit_old_file_hash) { continue; }
+        const int count_width = std::to_string(max_changes).size();
 
-        std::vector<std::string> new_lines, old_lines;
-        utils::get_lines_from_blob(index_new_file_hash, new_lines);
-        utils::get_lines_from_blob(commit_old_file_hash, old_lines);
-
-        if(index_new_file_mode == commit_old_file_mode) utils::write(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, str);
-        if(index_new_file_mode == commit_old_file_mode) utils::write(utils::INFO, "old:", old_str);
-        if(index_new_file_mode == commit_old_file_mode) utils::write(utils::INFO, "new:", new_str);
-        utils::write(utils::INFO, "---", "a/" + filepath);
-        utils::write(utils::INFO, "+++", "b/" + filepath);
-        show_line_diff(old_lines, new_lines);
-        utils::write(utils::EMPTY);
-    }    
+        for(size_t i = 0; i < entries.size(); ++i) {
+            const auto& [deleted, added] = counts[i];
+            int deleted_bar = deleted, added_bar = added;
 
-    for(const std::pair<std::string, std::pair<std::string, std::string>>& p : last_commit_files) {
-        const std::string& filepath = p.first;
-        const std::string commit_old_file_mode = p.second.first; // mode
-        const std::string commit_old_file_hash = p.second.second; // blob_hash
+            // Scale the bar down so the largest file fits into max_bar_width
+            if(max_changes > max_bar_width) {
+                deleted_bar = (int)((long long)deleted * max_bar_width / max_changes);
+                added_bar = (int)((long long)added * max_bar_width / max_changes);
+                if(deleted > 0 && deleted_bar == 0) deleted_bar = 1;
+                if(added > 0 && added_bar == 0) added_bar = 1;
+            }
 
-        auto it = index_files.find(filepath);
+            const std::string& filepath = names[i];
+            const std::string count = std::to_string(deleted + added);
+            const std::string bar = (added_bar ? utils::get_light_green_text(std::string(added_bar, '+')) : "") + (deleted_bar ? utils::get_red_text(std::string(deleted_bar, '-')) : "");
 
-        if(it == index_files.end()) {
-            utils::write(utils::INFO, "diff:", "a/" + filepath, "b/" + filepath, commit_old_file_hash, commit_old_file_mode);
-            utils::write(utils::INFO, "deleted file:", filepath);
-            utils::write(utils::EMPTY);
+            utils::write(utils::INFO, filepath + std::string(max_path_size - filepath.size(), ' '), "|", std::string(count_width - count.size(), ' ') + count, bar);
         }
+
+        utils::write(utils::EMPTY);
+        utils::write(utils::INFO, entries.size(), "files changed,", total_added, "insertions(+),", total_deleted, "deletions(-)");
     }
+
+    utils::write(utils::EMPTY);
 }
 
 void DiffCommand::commit1_and_commit2_diff(const std::string commit_hash1, const std::string commit_hash2) {
     const std::string tree_hash1 = utils::get_tree_hash_from_commit(commit_hash1);
     std::map<std::string, std::pair<std::string, std::string>> commit_hash1_files; // {file_path, blob_hash}
-    solve(tree_hash1, "", commit_hash1_files);
+    solve(tree_hash1, "", commit_hash1_files, {});
 
     const std::string tree_hash2 = utils::get_tree_hash_from_commit(commit_hash2);
     std::map<std::string, std::pair<std::string, std::string>> commit_hash2_files; // {file_path, blob_hash}
-    solve(tree_hash2, "", commit_hash2_files);
+    solve(tree_hash2, "", commit_hash2_files, {});
+
+    if(this->format != DiffFormat::PATCH) {
+        std::vector<DiffEntry> entries;
+        collect_tree_changes(commit_hash1_files, commit_hash2_files, this->format, entries);
+        print_summary(entries, false);
+        return;
+    }
 
-    compare_diffs(commit_hash1_files, commit_hash2_files);
+    compare_diffs(commit_hash1_files, commit_hash2_files, this->word_diff);
 }
 
 void DiffCommand::execute(std::vector<std::string>& args) {
     int args_size = args.size();
 
-    if(args_size == 0) {
+    if(args_size == 0 && this->format != DiffFormat::PATCH) {
+        std::vector<DiffEntry> entries;
+        collect_worktree_changes(entries, this->format == DiffFormat::STAT);
+        print_summary(entries, true);
+    }
+    else if(args_size == 0) {
         std::map<std::string, std::pair<std::string, std::string>> index_files; // {file_path, blob_hash}
         get_index_files(index_files);
-        print_diff(index_files);
+        print_diff(index_files, this->word_diff);
+    }
+    else if(args_size == 1 && args[0] != "--staged" && args[0] != "--cached") {
+        const std::string branch_path = config::REFS_HEAD_DIR + args[0];
+        const std::string commit_hash = fs::exists(branch_path) ? utils::read_file_content(branch_path) : args[0];
+
+        std::vector<DiffEntry> entries;
+        collect_commit_worktree_changes(commit_hash, entries, this->format != DiffFormat::NAME_ONLY && this->format != DiffFormat::NAME_STATUS);
+
+        if(this->format != DiffFormat::PATCH) { print_summary(entries, true); }
+        else { print_commit_worktree_diff(entries, this->word_diff); }
     }
     else if(args_size == 1) {
         std::map<std::string, std::pair<std::string, std::string>> index_files; // {file_path, blob_hash}
         get_index_files(index_files);
 
         std::map<std::string, std::pair<std::string, std::string>> last_commit_files; // {file_path, blob_hash}
-        get_last_commit_files(last_commit_files);
+        get_last_commit_files(last_commit_files, index_files);
+
+        if(this->format != DiffFormat::PATCH) {
+            std::vector<DiffEntry> entries;
+            collect_tree_changes(index_files, last_commit_files, this->format, entries);
+            print_summary(entries, false);
+            return;
+        }
 
-        compare_diffs(index_files, last_commit_files);
+        compare_diffs(index_files, last_commit_files, this->word_diff);
     }
     else if(args_size == 2) {
         const std::string branch1_path = config::REFS_HEAD_DIR + args[0];
@@ -0,0 +1,134 @@
+#include "commands/fetch.hpp"
+
+void FetchCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs fetch <path-to-repository>");
+    utils::write(utils::EMPTY);
+}
+
+void FetchCommand::validate(std::vector<std::string>& args) {
+    const int args_size = args.size();
+
+    if(args_size < 1) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(args_size > 1) {
+        const std::string error_msg = "Too many arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    this->source_path = args[0];
+    const fs::path source_objects_dir = fs::path(this->source_path) / config::OBJECTS_DIR;
+
+    if(!fs::is_directory(source_objects_dir)) {
+        const std::string error_msg = "Invalid path: '" + this->source_path + "' is not a VCS repository.";
+        throw std::invalid_argument(error_msg);
+    }
+
+    // A worktree links to the objects of its main repository, there is nothing to fetch between them
+    if(fs::exists(config::OBJECTS_DIR) && fs::canonical(source_objects_dir) == fs::canonical(config::OBJECTS_DIR)) {
+        const std::string error_msg = "Invalid path: '" + this->source_path + "' shares the objects of this repository.";
+        throw std::invalid_argument(error_msg);
+    }
+}
+
+std::map<std::string, std::string> FetchCommand::read_branch_heads(const std::string& repo_path) {
+    std::map<std::string, std::string> heads;
+    const fs::path heads_dir = fs::path(repo_path) / config::REFS_HEAD_DIR;
+
+    for(const std::string& branch : utils::get_all_branches(heads_dir.string())) {
+        const std::string commit_hash = utils::read_file_content((heads_dir / branch).string());
+        if(utils::is_valid_branch_name(branch) && utils::is_valid_hash_syntax(commit_hash)) { heads[branch] = commit_hash; }
+    }
+
+    return heads;
+}
+
+std::size_t FetchCommand::fetch_objects(const std::string& source_path, const std::vector<std::string>& want_hashes, const std::vector<std::string>& have_hashes) {
+    // The sending side runs from inside the source repository, only the list of objects comes back, with absolute paths
+    std::vector<std::pair<std::string, std::string>> objects;
+    {
+        utils::RepositoryScope source_scope(source_path);
+        for(const std::string& object_hash : get_pack_objects(want_hashes, have_hashes)) {
+            objects.emplace_back(object_hash, fs::absolute(utils::get_object_path(object_hash)).string());
+        }
+    }
+
+    return transfer_objects(objects);
+}
+
+std::string FetchCommand::get_remote_name(const fs::path& source_path) {
+    const std::string name = source_path.stem().string();
+    return (name.empty() || name == "." || name == "..") ? "origin" : name;
+}
+
+void FetchCommand::store_remote_heads(const std::string& remote, const std::map<std::string, std::string>& heads) {
+    const std::map<std::string, std::string> remote_heads = read_remote_heads();
+    const std::string remote_dir = config::REFS_REMOTES_DIR + remote + "/";
+
+    if(utils::create_directory(config::REFS_REMOTES_DIR) == utils::DIR_STATUS::ERROR || utils::create_directory(remote_dir) == utils::DIR_STATUS::ERROR) {
+        const std::string error_msg = "Failed to create directory: " + remote_dir;
+        throw std::runtime_error(error_msg);
+    }
+
+    for(const auto& [branch, commit_hash] : heads) {
+        if(commit_hash == std::string(40, '0')) { continue; }
+
+        const std::string remote_branch = remote + "/" + branch;
+        auto it = remote_heads.find(remote_branch);
+        if(it != remote_heads.end() && it->second == commit_hash) {
+            utils::write(utils::INFO, "[up to date]", branch, "-> remotes/" + remote_branch);
+            continue;
+        }
+
+        std::ofstream ref_file(remote_dir + branch, std::ios::out | std::ios::trunc);
+        if(!ref_file) {
+            const std::string error_msg = "Failed to open file: " + remote_dir + branch;
+            throw std::runtime_error(error_msg);
+        }
+        ref_file << commit_hash;
+        ref_file.close();
+
+        const std::string change = (it != remote_heads.end()) ? it->second.substr(0, 7) + ".." + commit_hash.substr(0, 7) : "[new branch]";
+        utils::write(utils::INFO, change, branch, "-> remotes/" + remote_branch);
+    }
+}
+
+std::map<std::string, std::string> FetchCommand::read_remote_heads() {
+    std::map<std::string, std::string> remote_heads;
+    if(!utils::is_directory_exist(config::REFS_REMOTES_DIR)) { return remote_heads; }
+
+    for(const auto& entry : fs::recursive_directory_iterator(config::REFS_REMOTES_DIR)) {
+        if(!entry.is_regular_file()) { continue; }
+
+        const std::string remote_branch = fs::relative(entry.path(), config::REFS_REMOTES_DIR).generic_string();
+        remote_heads[remote_branch] = utils::read_file_content(entry.path().string());
+    }
+    return remote_heads;
+}
+
+void FetchCommand::execute(std::vector<std::string>& args) {
+    utils::create_vcs_structure();
+
+    const std::map<std::string, std::string> source_heads = read_branch_heads(this->source_path);
+
+    // What this repository has: its branch heads and what earlier fetches brought
+    std::vector<std::string> have_hashes;
+    for(const auto& [branch, commit_hash] : read_branch_heads(".")) { have_hashes.push_back(commit_hash); }
+    for(const auto& [branch, commit_hash] : read_remote_heads()) { have_hashes.push_back(commit_hash); }
+
+    std::vector<std::string> want_hashes;
+    for(const auto& [branch, commit_hash] : source_heads) {
+        if(commit_hash != std::string(40, '0')) { want_hashes.push_back(commit_hash); }
+    }
+
+    const fs::path source_dir = fs::canonical(this->source_path);
+    const std::size_t object_count = fetch_objects(source_dir.string(), want_hashes, have_hashes);
+    utils::write(utils::INFO, "Received", object_count, "objects.");
+
+    store_remote_heads(get_remote_name(source_dir), source_heads);
+    utils::write(utils::OK);
+}
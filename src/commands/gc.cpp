@@ -0,0 +1,94 @@
+#include "commands/gc.hpp"
+
+void GcCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs gc");
+    utils::write(utils::INFO, "flag  : --prune=now (also delete unreachable objects younger than " + std::to_string(config::GC_PRUNE_GRACE_DAYS) + " days)");
+    utils::write(utils::EMPTY);
+}
+
+void GcCommand::validate(std::vector<std::string>& args) {
+    for(const std::string& arg : args) {
+        if(arg == "--prune=now") {
+            this->is_prune_now = true;
+            continue;
+        }
+
+        const std::string error_msg = "Invalid argument: " + arg;
+        throw std::invalid_argument(error_msg);
+    }
+}
+
+std::vector<std::string> GcCommand::select_bitmap_commits(const std::vector<std::string>& head_hashes) {
+    CommitGraph graph;
+    std::vector<std::string> commit_hashes;
+    std::unordered_set<std::string> seen;
+
+    for(const std::string& head_hash : head_hashes) {
+        std::string commit_hash = head_hash;
+
+        // Branches share their history, the walk stops where an earlier branch already went
+        for(int depth = 0; !commit_hash.empty() && seen.insert(commit_hash).second; ++depth) {
+            if(depth % config::BITMAP_COMMIT_INTERVAL == 0) { commit_hashes.push_back(commit_hash); }
+
+            const CommitNode& node = graph.get_commit(commit_hash);
+            commit_hash = node.parents.empty() ? "" : node.parents[0];
+        }
+    }
+
+    return commit_hashes;
+}
+
+void GcCommand::execute(std::vector<std::string>& args) {
+    std::vector<std::string> root_commits, root_objects;
+    collect_roots(root_commits, root_objects);
+
+    // The previous bitmaps cut the walk short, objects written since then are walked one by one
+    ReachabilityIndex index;
+    index.load();
+
+    std::vector<uint64_t> bits;
+    std::unordered_set<std::string> other_hashes;
+    index.get_reachable(root_commits, root_objects, bits, other_hashes);
+
+    const auto prune_before = fs::file_time_type::clock::now() - std::chrono::hours(24 * config::GC_PRUNE_GRACE_DAYS);
+    std::vector<std::string> reachable_hashes;
+    int pruned_count = 0, kept_count = 0;
+
+    for(const std::string& object_hash : list_loose_objects()) {
+        if(index.contains(bits, object_hash) || other_hashes.count(object_hash)) {
+            reachable_hashes.push_back(object_hash);
+            continue;
+        }
+
+        const std::string object_path = utils::get_object_path(object_hash);
+        if(!this->is_prune_now && fs::last_write_time(object_path) > prune_before) {
+            ++kept_count;
+            continue;
+        }
+
+        fs::remove(object_path);
+        ++pruned_count;
+
+        const fs::path object_dir = fs::path(object_path).parent_path();
+        if(fs::is_empty(object_dir)) { fs::remove(object_dir); }
+    }
+
+    std::vector<std::string> head_hashes;
+    for(const std::string& branch : utils::get_all_branches(config::REFS_HEAD_DIR)) {
+        const std::string head_hash = utils::read_file_content(config::REFS_HEAD_DIR + branch);
+        if(head_hash != std::string(40, '0')) { head_hashes.push_back(head_hash); }
+    }
+    if(utils::is_head_detached()) { head_hashes.push_back(utils::get_head_commit_hash()); }
+
+    index.build(reachable_hashes, select_bitmap_commits(head_hashes));
+    index.write();
+
+    utils::write(utils::OK, "Reachable objects:", std::to_string(reachable_hashes.size()));
+    utils::write(utils::OK, "Pruned objects:", std::to_string(pruned_count));
+    if(kept_count > 0) {
+        utils::write(utils::INFO, std::to_string(kept_count), "unreachable objects are younger than", std::to_string(config::GC_PRUNE_GRACE_DAYS), "days and were kept, use --prune=now to delete them.");
+    }
+    utils::write(utils::OK, "Bitmaps written:", std::to_string(index.bitmap_count()));
+}
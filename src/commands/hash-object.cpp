@@ -36,6 +36,9 @@ std::string HashObjectCommand::write_obj(const std::stringstream& buffer, const
     const std::string content = buffer.str();
     const std::string hash = utils::sha1(content);
 
+    // Already here or in an alternate object directory
+    if (utils::is_exist_obj(hash)) { return hash; }
+
     std::string header = type + " " + std::to_string(content.size()) + '\0';
     std::string full_content = header + content;
 
@@ -46,7 +49,6 @@ std::string HashObjectCommand::write_obj(const std::stringstream& buffer, const
     }
 
     std::string obj_file_path = obj_path + hash.substr(2);
-    if (utils::is_file_exist(obj_file_path)) { return hash; }
     
     std::string compressed = utils::compress_zlib(full_content);
 
@@ -10,32 +10,6 @@
 //     std::string message;
 // };
 
-std::string get_branch_and_parent(const std::string& cur_commit_hash, std::unordered_map<std::string, std::string>& commit_hash_parent) {
-    const std::vector<std::string> branches = utils::get_all_branches(config::LOG_REFS_HEAD_DIR);
-
-    std::string branch_name;
-
-    for (const std::string& branch : branches) {
-        const std::string branch_path = config::LOG_REFS_HEAD_DIR + branch;
-        const std::string branch_logs_data = utils::read_file_content(branch_path);
-
-        std::ifstream file(branch_path);
-        std::string line;
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string parent_hash, commit_hash, others;
-            iss >> parent_hash >> commit_hash >> others;
-            
-            if (commit_hash == cur_commit_hash) {
-                branch_name = branch; // Found the branch that contains the commit hash
-            }
-
-            commit_hash_parent[commit_hash] = parent_hash;      // create linked list 
-        }
-    }
-    return branch_name; // No branch found with the given commit hash
-}
-
 Commit get_commit_data(const std::string& commit_hash) {
     if (commit_hash.empty() || commit_hash == std::string(40, '0')) {
         throw std::logic_error("Invalid or empty commit hash provided to get_commit_data.");
@@ -79,68 +53,366 @@ Commit get_commit_data(const std::string& commit_hash) {
     return commit;
 }
 
-std::pair<std::string, std::vector<Commit>> get_all_commits() {
-    std::string head_commit_hash = utils::get_head_commit_hash();
-    std::unordered_map<std::string, std::string> parent;
-    
-    std::string cur_branch = get_branch_and_parent(head_commit_hash, parent);
-    const std::string head_content = utils::read_file_content(config::HEAD_FILE);
-    if(head_content.find("ref: ") != std::string::npos) {
-        cur_branch = utils::get_current_branch();
+// True when the commit changed 'path' compared to its first parent. The Bloom filter rules most commits out without
+// reading any tree, the rest are checked by looking the path up in both trees.
+bool is_path_changed(const CommitGraphFile& graph_file, CommitGraph& graph, const std::string& commit_hash, const std::string& path) {
+    if (!graph_file.may_have_changed(commit_hash, path)) { return false; }
+
+    const CommitNode& commit = graph.get_commit(commit_hash);
+
+    TreeEntry entry, parent_entry;
+    const bool has_entry = utils::find_tree_entry(commit.tree_hash, path, entry);
+    const bool parent_has_entry = !commit.parents.empty() && utils::find_tree_entry(graph.get_commit(commit.parents.front()).tree_hash, path, parent_entry);
+
+    if (has_entry != parent_has_entry) { return true; }
+    if (!has_entry) { return false; }
+
+    // Tree hashes also cover file mtimes, a directory only changed if a file in it did
+    if (entry.type == "tree" && parent_entry.type == "tree") { return !diff_engine::diff_trees(parent_entry.hash, entry.hash).empty(); }
+
+    return entry.type != parent_entry.type || entry.hash != parent_entry.hash || entry.mode != parent_entry.mode;
+}
+
+TopoWalk::TopoWalk(CommitGraph& graph, const std::vector<std::string>& start_hashes) : graph(graph) {
+    for (const std::string& commit_hash : start_hashes) {
+        if (!seen.insert(commit_hash).second) { continue; }
+
+        const uint32_t generation = graph.get_generation(commit_hash);
+        walk_queue.push({generation, commit_hash});
+
+        // Checked when it comes out: a start another start descends from waits for its children
+        ready_queue.push({graph.get_commit(commit_hash).time, generation, commit_hash});
     }
+}
 
-    std::vector<Commit> all_commits;
-    std::string current_commit = utils::get_commit_hash(cur_branch);
+void TopoWalk::walk_to(const uint32_t generation) {
+    // Children always have a higher generation, so once everything above a commit's generation is walked its
+    // in-degree is final
+    while (!walk_queue.empty() && walk_queue.top().first > generation) {
+        const std::string commit_hash = walk_queue.top().second;
+        walk_queue.pop();
 
-    const std::string root_hash = std::string(40, '0'); // Represents the root commit
-    while (current_commit != root_hash) {
-        Commit commit = get_commit_data(current_commit);
-        all_commits.push_back(commit);
-        current_commit = parent[current_commit]; // Move to the parent commit
+        for (const std::string& parent_hash : graph.get_commit(commit_hash).parents) {
+            ++indegree[parent_hash];
+            if (seen.insert(parent_hash).second) { walk_queue.push({graph.get_generation(parent_hash), parent_hash}); }
+        }
     }
+}
 
-    return {cur_branch, all_commits};
+bool TopoWalk::next(std::string& commit_hash) {
+    while (!ready_queue.empty()) {
+        const std::string candidate = std::get<2>(ready_queue.top());
+        ready_queue.pop();
+        if (shown.count(candidate)) { continue; }
+
+        walk_to(graph.get_generation(candidate));
+        if (indegree[candidate] > 0) { continue; } // comes back once its last child is shown
+
+        shown.insert(candidate);
+
+        for (const std::string& parent_hash : graph.get_commit(candidate).parents) {
+            const uint32_t parent_generation = graph.get_generation(parent_hash);
+            walk_to(parent_generation);
+            if (--indegree[parent_hash] == 0) { ready_queue.push({graph.get_commit(parent_hash).time, parent_generation, parent_hash}); }
+        }
+
+        commit_hash = candidate;
+        return true;
+    }
+    return false;
 }
 
-void printCommits(const std::pair<std::string, std::vector<Commit>>& branch_and_commits) {
-    const std::string head_commit_hash = utils::get_head_commit_hash();
-    const std::string cur_branch = branch_and_commits.first;
-    
-    utils::write(utils::EMPTY);
-    for (const Commit& c : branch_and_commits.second) {
+void GraphRenderer::draw_shift(std::vector<std::pair<int, int>> edges, std::vector<std::string>& lines) {
+    auto is_moving = [&]() {
+        return std::any_of(edges.begin(), edges.end(), [](const std::pair<int, int>& edge) { return edge.first != edge.second; });
+    };
 
-        std::string head_indicator = (c.commit_hash == head_commit_hash) ? "(HEAD -> " + cur_branch + ")" : "";
+    while (is_moving()) {
+        int width = 0;
+        for (const auto& [from, to] : edges) { width = std::max({width, from, to}); }
 
-        // Convert timestamp to readable time
-        std::time_t t = c.timestamp;
-        std::tm* tm_info = std::localtime(&t);
-        char date_str[100];
-        std::strftime(date_str, sizeof(date_str), "%a %b %d %H:%M:%S %Y", tm_info);
+        std::string line(2 * width + 2, ' ');
+        for (auto& [from, to] : edges) {
+            if (from == to) { line[2 * from] = '|'; }
+            else if (from < to) { line[2 * from + 1] = '\\'; ++from; }
+            else { line[2 * from - 1] = '/'; --from; }
+        }
 
-        utils::write(utils::INFO, "Commit  :", c.commit_hash, head_indicator);
-        utils::write(utils::INFO, "Author  :", c.username);
-        utils::write(utils::INFO, "Date    :", date_str);
-        utils::write(utils::INFO, "Message :", c.message);
-        utils::write(utils::EMPTY);
+        line.erase(line.find_last_not_of(' ') + 1);
+        lines.push_back(line);
     }
-    utils::write(utils::END);
 }
 
-void LogCommand::help() {}
+void GraphRenderer::add_commit(const std::string& commit_hash, const std::vector<std::string>& parents, std::string& prefix, std::vector<std::string>& lines_before, std::vector<std::string>& lines_after) {
+    // Children waiting for this commit in several lanes join the first of them
+    int column = -1;
+    std::vector<std::string> joined_lanes;
+    std::vector<std::pair<int, int>> edges;
+
+    for (int i = 0; i < (int)lanes.size(); i++) {
+        if (lanes[i] == commit_hash && column >= 0) { edges.push_back({i, column}); continue; }
+        if (lanes[i] == commit_hash) { column = joined_lanes.size(); }
+
+        edges.push_back({i, (int)joined_lanes.size()});
+        joined_lanes.push_back(lanes[i]);
+    }
+
+    if (column < 0) {
+        column = joined_lanes.size(); // a branch tip starts a new lane
+        joined_lanes.push_back(commit_hash);
+    }
+
+    draw_shift(edges, lines_before);
+    lanes = joined_lanes;
+
+    prefix.clear();
+    for (int i = 0; i < (int)lanes.size(); i++) { prefix += (i == column) ? "* " : "| "; }
+
+    // The commit's lane is handed to its parents, a parent some other lane waits for already is joined there
+    std::vector<std::string> new_lanes;
+    std::vector<int> new_columns(lanes.size(), -1);
+
+    for (int i = 0; i < (int)lanes.size(); i++) {
+        if (i != column) {
+            new_columns[i] = new_lanes.size();
+            new_lanes.push_back(lanes[i]);
+            continue;
+        }
+
+        for (const std::string& parent_hash : parents) {
+            const bool is_waiting = std::find(lanes.begin(), lanes.end(), parent_hash) != lanes.end();
+            const bool is_added = std::find(new_lanes.begin(), new_lanes.end(), parent_hash) != new_lanes.end();
+            if (!is_waiting && !is_added) { new_lanes.push_back(parent_hash); }
+        }
+    }
+
+    std::vector<std::pair<int, int>> parent_edges;
+    for (int i = 0; i < (int)lanes.size(); i++) {
+        if (i != column) { parent_edges.push_back({i, new_columns[i]}); }
+    }
+    for (const std::string& parent_hash : parents) {
+        parent_edges.push_back({column, int(std::find(new_lanes.begin(), new_lanes.end(), parent_hash) - new_lanes.begin())});
+    }
+
+    draw_shift(parent_edges, lines_after);
+    lanes = new_lanes;
+}
+
+// "(HEAD -> master, feat)" for every commit a branch points at
+std::unordered_map<std::string, std::string> get_decorations() {
+    std::unordered_map<std::string, std::vector<std::string>> names;
+
+    const bool is_detached = utils::is_head_detached();
+    const std::string cur_branch = is_detached ? "" : utils::get_current_branch();
+    if (is_detached) { names[utils::get_head_commit_hash()].push_back("HEAD"); }
+    else { names[utils::get_commit_hash(cur_branch)].push_back("HEAD -> " + cur_branch); }
+
+    std::vector<std::string> branches = utils::get_all_branches(config::REFS_HEAD_DIR);
+    std::sort(branches.begin(), branches.end());
+    for (const std::string& branch : branches) {
+        if (branch != cur_branch) { names[utils::get_commit_hash(branch)].push_back(branch); }
+    }
+
+    std::unordered_map<std::string, std::string> decorations;
+    for (const auto& [commit_hash, commit_names] : names) {
+        std::string decoration = "(";
+        for (size_t i = 0; i < commit_names.size(); i++) { decoration += (i ? ", " : "") + commit_names[i]; }
+        decorations[commit_hash] = decoration + ")";
+    }
+    return decorations;
+}
+
+void print_commit(const Commit& c, const std::string& head_indicator, const bool is_oneline) {
+    if (is_oneline) {
+        // First line of the message only
+        const std::string short_hash = c.commit_hash.substr(0, 7) + (head_indicator.empty() ? "" : " " + head_indicator);
+        utils::write(utils::INFO, short_hash, c.message.substr(0, c.message.find('\n')));
+        return;
+    }
+
+    // Convert timestamp to readable time
+    std::time_t t = c.timestamp;
+    std::tm* tm_info = std::localtime(&t);
+    char date_str[100];
+    std::strftime(date_str, sizeof(date_str), "%a %b %d %H:%M:%S %Y", tm_info);
+
+    utils::write(utils::INFO, "Commit  :", c.commit_hash, head_indicator);
+    utils::write(utils::INFO, "Author  :", c.username);
+    utils::write(utils::INFO, "Date    :", date_str);
+    utils::write(utils::INFO, "Message :", c.message);
+    utils::write(utils::EMPTY);
+}
+
+// Unix timestamp, "YYYY-MM-DD" or "YYYY-MM-DD HH:MM:SS" (local time), -1 when it's none of them
+std::time_t parse_since(const std::string& value) {
+    if (!value.empty() && std::all_of(value.begin(), value.end(), ::isdigit) && value.size() > 8) {
+        return std::stoll(value);
+    }
+
+    for (const char* format : {"%Y-%m-%d %H:%M:%S", "%Y-%m-%d"}) {
+        std::tm tm = {};
+        std::istringstream iss(value);
+        iss >> std::get_time(&tm, format);
+        if (!iss.fail() && iss.peek() == EOF) {
+            tm.tm_isdst = -1;
+            return std::mktime(&tm);
+        }
+    }
+    return -1;
+}
+
+void LogCommand::help() {
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs log [options]");
+    utils::write(utils::INFO, "usage : vcs log [options] -- <path>    (only commits that changed <path>, a file or directory)");
+    utils::write(utils::INFO, "flag  : -n <count>, --max-count=<count>   (stop after <count> commits)");
+    utils::write(utils::INFO, "flag  : --since=<date>                    (stop at commits older than <date>: YYYY-MM-DD[ HH:MM:SS] or a unix timestamp)");
+    utils::write(utils::INFO, "flag  : --oneline                         (one line per commit: short hash and first line of the message)");
+    utils::write(utils::INFO, "flag  : --all                             (every branch, in topological order)");
+    utils::write(utils::INFO, "flag  : --graph                           (one line per commit with an ASCII graph of the history)");
+    utils::write(utils::EMPTY);
+}
 
 void LogCommand::validate(std::vector<std::string>& args) {
-    int args_size = args.size();
+    const int args_size = args.size();
+
+    // The value of an option given as "--name=value" or "--name value"
+    auto get_value = [&](int& i, const std::string& name) {
+        if (args[i].size() > name.size() && args[i].compare(0, name.size() + 1, name + "=") == 0) { return args[i].substr(name.size() + 1); }
+        if (i + 1 >= args_size) {
+            const std::string error_msg = "Missing value for " + name;
+            throw std::invalid_argument(error_msg);
+        }
+        return args[++i];
+    };
 
-    if(args_size > 0) {
-        const std::string error_msg = "Too many arguments";
-        throw std::invalid_argument(error_msg);    
+    auto parse_count = [](const std::string& value) {
+        if (value.empty() || value.size() > 9 || !std::all_of(value.begin(), value.end(), ::isdigit)) {
+            const std::string error_msg = "Invalid count: " + value;
+            throw std::invalid_argument(error_msg);
+        }
+        return std::stoi(value);
+    };
+
+    for (int i = 0; i < args_size; i++) {
+        const std::string& arg = args[i];
+
+        if (arg == "--") {
+            if (i + 2 != args_size) {
+                const std::string error_msg = (i + 1 == args_size) ? "Missing path after --" : "Too many arguments";
+                throw std::invalid_argument(error_msg);
+            }
+
+            path = utils::normalizeRelativePath(args[i + 1]);
+            if (path.empty()) {
+                const std::string error_msg = "Invalid path: " + args[i + 1];
+                throw std::invalid_argument(error_msg);
+            }
+            break;
+        }
+        else if (arg == "--oneline") { is_oneline = true; }
+        else if (arg == "--all") { is_all = true; }
+        else if (arg == "--graph") { is_graph = true; }
+        else if (arg == "-n" || arg.rfind("--max-count", 0) == 0) { max_count = parse_count(get_value(i, arg == "-n" ? "-n" : "--max-count")); }
+        else if (arg.rfind("-n", 0) == 0) { max_count = parse_count(arg.substr(2)); } // -n10
+        else if (arg.rfind("--since", 0) == 0) {
+            const std::string value = get_value(i, "--since");
+            since = parse_since(value);
+            if (since < 0) {
+                const std::string error_msg = "Invalid date: " + value;
+                throw std::invalid_argument(error_msg);
+            }
+        }
+        else {
+            const std::string error_msg = "Invalid argument: " + arg;
+            throw std::invalid_argument(error_msg);
+        }
+    }
+
+    if (is_graph && !path.empty()) {
+        const std::string error_msg = "--graph can't be combined with -- <path>";
+        throw std::invalid_argument(error_msg);
     }
 }
 
+// Without --all or --graph, walks first parents from HEAD. Otherwise every parent is followed in topological order.
+// Either way commits come straight from the commit graph and are printed as soon as they're reached, so
+// --max-count and --since stop the walk without touching the rest of the history.
 void LogCommand::execute(std::vector<std::string>& args) {
     utils::create_vcs_structure();
 
-    const std::pair<std::string, std::vector<Commit>> branch_and_commits = get_all_commits();
+    const std::string head_commit_hash = utils::get_head_commit_hash();
+    const std::string root_hash = std::string(40, '0'); // Represents the root commit
+
+    const std::unordered_map<std::string, std::string> decorations = get_decorations();
+    auto get_decoration = [&](const std::string& commit_hash) {
+        auto it = decorations.find(commit_hash);
+        return (it == decorations.end()) ? std::string() : it->second;
+    };
+
     utils::write(utils::OK);
-    printCommits(branch_and_commits);
-}
\ No newline at end of file
+    if (!is_oneline && !is_graph) { utils::write(utils::EMPTY); }
+
+    CommitGraph graph;
+    const CommitGraphFile graph_file;
+    int shown = 0;
+
+    if (!is_all && !is_graph) {
+        std::string current_commit = head_commit_hash.empty() ? root_hash : head_commit_hash;
+
+        while (current_commit != root_hash && (max_count < 0 || shown < max_count)) {
+            const CommitNode& node = graph.get_commit(current_commit);
+            if (node.time < since) { break; }
+
+            if (path.empty() || is_path_changed(graph_file, graph, current_commit, path)) {
+                print_commit(get_commit_data(current_commit), get_decoration(current_commit), is_oneline);
+                ++shown;
+            }
+
+            current_commit = node.parents.empty() ? root_hash : node.parents.front(); // Move to the first parent
+        }
+
+        utils::write(utils::END);
+        return;
+    }
+
+    std::vector<std::string> start_hashes;
+    if (!head_commit_hash.empty() && head_commit_hash != root_hash) { start_hashes.push_back(head_commit_hash); }
+    if (is_all) {
+        for (const std::string& branch : utils::get_all_branches(config::REFS_HEAD_DIR)) {
+            const std::string commit_hash = utils::get_commit_hash(branch);
+            if (!commit_hash.empty() && commit_hash != root_hash) { start_hashes.push_back(commit_hash); }
+        }
+    }
+
+    TopoWalk walk(graph, start_hashes);
+    GraphRenderer renderer;
+    std::string commit_hash;
+
+    while ((max_count < 0 || shown < max_count) && walk.next(commit_hash)) {
+        const CommitNode& node = graph.get_commit(commit_hash);
+
+        // Commits come newest first, those left are older still
+        if (node.time < since) { break; }
+        if (!path.empty() && !is_path_changed(graph_file, graph, commit_hash, path)) { continue; }
+
+        const Commit commit = get_commit_data(commit_hash);
+        ++shown;
+
+        if (!is_graph) {
+            print_commit(commit, get_decoration(commit_hash), is_oneline);
+            continue;
+        }
+
+        std::string prefix;
+        std::vector<std::string> lines_before, lines_after;
+        renderer.add_commit(commit_hash, node.parents, prefix, lines_before, lines_after);
+
+        const std::string decoration = get_decoration(commit_hash);
+        for (const std::string& line : lines_before) { utils::write(utils::INFO, line); }
+        utils::write(utils::INFO, prefix + commit_hash.substr(0, 7) + (decoration.empty() ? "" : " " + decoration), commit.message.substr(0, commit.message.find('\n')));
+        for (const std::string& line : lines_after) { utils::write(utils::INFO, line); }
+    }
+
+    utils::write(utils::END);
+}
@@ -0,0 +1,66 @@
+#include "commands/merge-base.hpp"
+
+void MergeBaseCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs merge-base <commit1> <commit2>");
+    utils::write(utils::INFO, "usage : vcs merge-base <branch1> <branch2>");
+    utils::write(utils::INFO, "flag  : --all (print every best common ancestor)");
+    utils::write(utils::EMPTY);
+}
+
+void MergeBaseCommand::validate(std::vector<std::string>& args) {
+    if(!args.empty() && args[0] == "--all") {
+        this->is_all = true;
+        args.erase(args.begin());
+    }
+
+    const int args_size = args.size();
+
+    if(args_size < 2) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(args_size > 2) {
+        const std::string error_msg = "Too many arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    for(const std::string& name : args) {
+        if(utils::is_file_exist(config::REFS_HEAD_DIR + name)) { continue; }
+
+        if(CatFileCommand().get_object_type(name) != "commit") {
+            const std::string error_msg = "Invalid commit hash: " + name;
+            throw std::invalid_argument(error_msg);
+        }
+    }
+}
+
+std::string MergeBaseCommand::get_commit_hash(const std::string& name) {
+    const std::string branch_path = config::REFS_HEAD_DIR + name;
+    return utils::is_file_exist(branch_path) ? utils::read_file_content(branch_path) : name;
+}
+
+void MergeBaseCommand::execute(std::vector<std::string>& args) {
+    const std::string commit_hash1 = get_commit_hash(args[0]);
+    const std::string commit_hash2 = get_commit_hash(args[1]);
+
+    if(commit_hash1 == std::string(40, '0') || commit_hash2 == std::string(40, '0')) {
+        utils::write(utils::ERR, "No commits yet on the given branch.");
+        return;
+    }
+
+    CommitGraph graph;
+    const std::vector<std::string> merge_bases = graph.get_merge_bases(commit_hash1, commit_hash2);
+
+    if(merge_bases.empty()) {
+        utils::write(utils::ERR, "No common ancestor, the histories are unrelated.");
+        return;
+    }
+
+    const size_t count = this->is_all ? merge_bases.size() : 1;
+    for(size_t i = 0; i < count; ++i) {
+        utils::write(utils::OK, merge_bases[i]);
+    }
+}
@@ -23,166 +23,246 @@ void MergeCommand::validate(std::vector<std::string>& args) {
     }
 }
 
-void MergeCommand::solve(const std::string& tree_hash, std::string path, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files) {
-    const std::string tree_content = utils::read_and_decompress(utils::get_object_path(tree_hash));
-
-    // ./main.out ls-tree 6725736609ced67ff91c01194131fb5c1e96b795
-    // [ OK        ]  
-    // [ CONTENT   ]  tree 303 
-    // [ CONTENT   ]  100644 blob ee7b91e970e57c6b795e4f25e99f2e9e16d8f3fe 1750696059 31 demo.txt 
-    // [ CONTENT   ]  100755 blob c3b26da2c89459d767e20f9d0ca95d14b5e4b4d2 1750759111 2495376 main.out 
-    // [ CONTENT   ]  040000 tree 8e4df253a7968ffe2641eae68d8cfce7e0048258 1750696466 65 test1 
-    // [ CONTENT   ]  040000 tree 90e2141d7522fc9c83b99c3e50d3f507165ac71d 1750696477 65 test2 
-
-    std::stringstream ss(tree_content);
-    std::string line;
-    std::getline(ss, line); // Read the first line (tree 286)
-
-    while (std::getline(ss, line)) {
-        if (line.empty()) continue;
-
-        std::istringstream iss(line);
-        std::string mode, type, hash, mtime, size, file_name;
-        iss >> mode >> type >> hash >> mtime >> size >> file_name;
-
-        if (type == "tree") {
-            solve(hash, file_name + "/", last_commit_files); // Recursive call for sub-trees
-        } else if (type == "blob") {
-            const std::string filepath = path + file_name;
-            last_commit_files[filepath] = {mode, hash}; 
-        }
+using FileMap = diff_engine::FileMap;
+using File = std::pair<std::string, std::string>; // {mode, blob_hash}
+
+// What the merge did to the working directory, paths it didn't touch keep the current branch's version
+struct MergeResult {
+    SparseCheckout sparse;
+    FileMap written_files;                  // staged with fresh stat data
+    FileMap skip_worktree_files;            // outside of the sparse checkout, staged without being written
+    std::set<std::string> removed_files;
+    std::set<std::string> conflicted_files; // keep the current branch's index entry
+    std::set<std::string> renamed_paths;    // both names of a rename merged before the tree walk
+};
+
+void write_file(const std::string& filepath, const File& file, MergeResult& result) {
+    // Like checkout, a file outside of the sparse checkout only gets its index entry. Conflicts are still written.
+    if(result.sparse.is_skip_worktree(filepath)) {
+        result.skip_worktree_files[filepath] = file;
+        return;
     }
+
+    if(fs::is_symlink(filepath) || file.first == "120000") { fs::remove(filepath); }
+    utils::create_file_from_blob(filepath, file.second, file.first);
+    result.written_files[filepath] = file;
 }
 
-enum OpType { COMMON, BRANCH1, BRANCH2 };
-
-void merge(const std::vector<std::string>& lines1, const std::vector<std::string>& lines2, const std::string& filepath, const std::string& branch) {
-    int n = lines1.size();
-    int m = lines2.size();
-    std::vector<std::vector<int>> dp(n + 1, std::vector<int>(m + 1, 0));
-
-    // Build LCS DP table
-    for (int i = 1; i <= n; ++i) {
-        for (int j = 1; j <= m; ++j) {
-            if (lines1[i - 1] == lines2[j - 1]) {
-                dp[i][j] = 1 + dp[i - 1][j - 1];
-            } else {
-                dp[i][j] = std::max(dp[i - 1][j], dp[i][j - 1]);
-            }
-        }
+void remove_file(const std::string& filepath, MergeResult& result) {
+    utils::remove_worktree_file(filepath);
+    result.removed_files.insert(filepath);
+}
+
+// Brings the working directory from the old side of 'changes' to the new one. Deletions go first so a file can
+// take the place of a directory.
+void apply_changes(const std::vector<FileChange>& changes, MergeResult& result) {
+    for(const FileChange& change : changes) {
+        if(change.new_file.second.empty() && !result.renamed_paths.count(change.filepath)) { remove_file(change.filepath, result); }
+    }
+    for(const FileChange& change : changes) {
+        if(!change.new_file.second.empty() && !result.renamed_paths.count(change.filepath)) { write_file(change.filepath, change.new_file, result); }
     }
+}
 
-    // Backtrack to collect operations
-    int i = n, j = m;
-    std::vector<std::pair<OpType, std::string>> ops;
-
-    while (i > 0 && j > 0) {
-        if (lines1[i - 1] == lines2[j - 1]) {
-            ops.push_back({COMMON, lines1[i - 1]});
-            --i; --j;
-        } else if (dp[i - 1][j] >= dp[i][j - 1]) {
-            ops.push_back({BRANCH1, lines1[i - 1]});
-            --i;
-        } else {
-            ops.push_back({BRANCH2, lines2[j - 1]});
-            --j;
-        }
+// Line merge of a file modified on both sides, conflicts are written into the working directory with markers
+void merge_file(const std::string& filepath, const File* base, const File& ours, const File& theirs, const std::string& branch, MergeResult& result) {
+    std::vector<std::string> base_lines, ours_lines, theirs_lines, merged_lines;
+    if(base != nullptr) { utils::get_lines_from_blob(base->second, base_lines); }
+    utils::get_lines_from_blob(ours.second, ours_lines);
+    utils::get_lines_from_blob(theirs.second, theirs_lines);
+
+    const bool is_resolved = diff_engine::merge_lines(base_lines, ours_lines, theirs_lines, "HEAD", branch, merged_lines);
+
+    std::stringstream buffer;
+    for (const auto& line : merged_lines) { buffer << line << "\n"; }
+
+    if(is_resolved) {
+        const std::string mode = (base != nullptr && base->first == ours.first) ? theirs.first : ours.first;
+        write_file(filepath, {mode, HashObjectCommand::write_obj(buffer, "blob")}, result);
+        return;
     }
-    while (i > 0) {
-        ops.push_back({BRANCH1, lines1[i - 1]});
-        --i;
-    }
-    while (j > 0) {
-        ops.push_back({BRANCH2, lines2[j - 1]});
-        --j;
-    }
-
-    std::reverse(ops.begin(), ops.end());
-    std::vector<std::string> merged_output;
-
-    // Group operations into conflict blocks
-    for (int idx = 0; idx < ops.size(); ) {
-        if (ops[idx].first == COMMON) {
-            merged_output.push_back(ops[idx].second);
-            ++idx;
-        } else {
-            std::vector<std::string> branch1_lines;
-            std::vector<std::string> branch2_lines;
-            
-            // Collect all consecutive non-common operations
-            while (idx < ops.size() && ops[idx].first != COMMON) {
-                if (ops[idx].first == BRANCH1) {
-                    branch1_lines.push_back(ops[idx].second);
-                } else if (ops[idx].first == BRANCH2) {
-                    branch2_lines.push_back(ops[idx].second);
-                }
-                ++idx;
-            }
-            
-            // Add conflict markers only if there are changes
-            if (!branch1_lines.empty() && !branch2_lines.empty()) {
-                merged_output.push_back("<<<<<<< HEAD");
-                for (const auto& line : branch1_lines) {
-                    merged_output.push_back(line);
-                }
-                merged_output.push_back("=======");
-                for (const auto& line : branch2_lines) {
-                    merged_output.push_back(line);
-                }
-                merged_output.push_back(">>>>>>> " + branch);
-            }
-            else {
-                for (const auto& line : branch1_lines) {
-                    merged_output.push_back(line);
-                }
-                for (const auto& line : branch2_lines) {
-                    merged_output.push_back(line);
-                }
-            }
+
+    fs::path path(filepath);
+    if (path.has_parent_path()) { fs::create_directories(path.parent_path()); }
+
+    std::ofstream out(filepath, std::ios::binary | std::ios::trunc);
+    out << buffer.str();
+    out.close();
+
+    result.conflicted_files.insert(filepath);
+    utils::write(utils::CONFLICT, filepath);
+}
+
+// Files renamed on one side and modified under the old name on the other are merged under the new name.
+// Only files that differ from the merge base are looked at.
+void merge_renames(const std::string& base_tree_hash, const std::string& ours_tree_hash, const std::string& theirs_tree_hash, const std::string& branch, MergeResult& result) {
+    // modified files keep their new {mode, blob_hash}
+    auto split = [](const std::vector<FileChange>& changes, FileMap& deleted_files, FileMap& added_files, FileMap& modified_files) {
+        for(const FileChange& change : changes) {
+            if(change.new_file.second.empty()) { deleted_files[change.filepath] = change.old_file; }
+            else if(change.old_file.second.empty()) { added_files[change.filepath] = change.new_file; }
+            else { modified_files[change.filepath] = change.new_file; }
         }
+    };
+
+    FileMap deleted1, added1, modified1, deleted2, added2, modified2;
+    split(diff_engine::diff_trees(base_tree_hash, ours_tree_hash), deleted1, added1, modified1);
+    split(diff_engine::diff_trees(base_tree_hash, theirs_tree_hash), deleted2, added2, modified2);
+
+    // Renamed by <branch>, the current branch still has the file under the old name
+    for(const RenameMatch& rename : diff_engine::detect_renames(deleted2, added2, {})) {
+        if(deleted1.count(rename.old_path) || added1.count(rename.new_path)) { continue; }
+
+        utils::write(utils::RENAMED, rename.old_path, "->", rename.new_path, "(" + std::to_string(rename.similarity) + "%)");
+
+        // Unchanged on the current branch, the tree walk takes the rename as it is
+        auto it = modified1.find(rename.old_path);
+        if(it == modified1.end()) { continue; }
+
+        result.renamed_paths.insert(rename.old_path);
+        result.renamed_paths.insert(rename.new_path);
+        merge_file(rename.new_path, &deleted2.at(rename.old_path), it->second, added2.at(rename.new_path), branch, result);
+        remove_file(rename.old_path, result);
     }
 
-    // Write to output file
-    std::ofstream out(filepath);
-    for (const auto& line : merged_output) {
-        out << line << "\n";
+    // Renamed by the current branch, <branch> modified the file under the old name
+    for(const RenameMatch& rename : diff_engine::detect_renames(deleted1, added1, {})) {
+        if(deleted2.count(rename.old_path) || added2.count(rename.new_path)) { continue; }
+
+        auto it = modified2.find(rename.old_path);
+        if(it == modified2.end()) { continue; }
+
+        result.renamed_paths.insert(rename.old_path);
+        result.renamed_paths.insert(rename.new_path);
+        merge_file(rename.new_path, &deleted1.at(rename.old_path), added1.at(rename.new_path), it->second, branch, result);
     }
-    out.close();
 }
 
-void merge_branch(const std::map<std::string, std::pair<std::string, std::string>>& commit_hash1_files, const std::map<std::string, std::pair<std::string, std::string>>& commit_hash2_files, const std::string& branch) {
-    for(const std::pair<std::string, std::pair<std::string, std::string>>& p : commit_hash2_files) {
-        const std::string& filepath = p.first;
-        const std::string commit_hash2_file_mode = p.second.first; // mode
-        const std::string commit_hash2_file_hash = p.second.second; // blob_hash
+void read_entries(const std::string& tree_hash, std::map<std::string, TreeEntry>& entries) {
+    if(tree_hash.empty()) { return; }
+    for(const TreeEntry& entry : utils::read_tree(tree_hash)) { entries[entry.name] = entry; }
+}
+
+bool is_same_entry(const TreeEntry* entry1, const TreeEntry* entry2) {
+    if(entry1 == nullptr || entry2 == nullptr) { return entry1 == entry2; }
+    return entry1->type == entry2->type && entry1->hash == entry2->hash && (entry1->type == "tree" || entry1->mode == entry2->mode);
+}
+
+bool is_tree(const TreeEntry* entry) { return entry != nullptr && entry->type == "tree"; }
+bool is_blob(const TreeEntry* entry) { return entry != nullptr && entry->type != "tree"; }
+
+// Three-way merge of one directory level. Entries equal on two sides are settled without being read: the current
+// branch already has the result, or <branch>'s version is taken as a whole. Only subtrees changed on both sides are
+// walked, and only files changed on both sides are merged line by line. An empty hash stands for a missing tree.
+void merge_trees(const std::string& base_tree_hash, const std::string& ours_tree_hash, const std::string& theirs_tree_hash, const std::string& path, const std::string& branch, MergeResult& result) {
+    std::map<std::string, TreeEntry> base_entries, ours_entries, theirs_entries;
+    read_entries(base_tree_hash, base_entries);
+    read_entries(ours_tree_hash, ours_entries);
+    read_entries(theirs_tree_hash, theirs_entries);
+
+    std::set<std::string> names;
+    for(const auto* entries : {&base_entries, &ours_entries, &theirs_entries}) {
+        for(const auto& p : *entries) { names.insert(p.first); }
+    }
+
+    auto find_entry = [](const std::map<std::string, TreeEntry>& entries, const std::string& name) -> const TreeEntry* {
+        auto it = entries.find(name);
+        return (it == entries.end()) ? nullptr : &it->second;
+    };
+
+    for(const std::string& name : names) {
+        const std::string filepath = path + name;
+        if(result.renamed_paths.count(filepath)) { continue; }
 
-        if(commit_hash1_files.find(filepath) == commit_hash1_files.end()) {
-            utils::create_file_from_blob(filepath, commit_hash2_file_hash, commit_hash2_file_mode);
+        const TreeEntry* base = find_entry(base_entries, name);
+        const TreeEntry* ours = find_entry(ours_entries, name);
+        const TreeEntry* theirs = find_entry(theirs_entries, name);
+
+        // Changed on the current branch only, or the same way on both
+        if(is_same_entry(ours, theirs) || is_same_entry(base, theirs)) { continue; }
+
+        // Changed on <branch> only, the working directory moves from our version to theirs
+        if(is_same_entry(base, ours)) {
+            if(is_blob(ours) && !is_blob(theirs)) { remove_file(filepath, result); }
+            apply_changes(diff_engine::diff_trees(is_tree(ours) ? ours->hash : "", is_tree(theirs) ? theirs->hash : "", filepath + "/"), result);
+            if(is_blob(theirs)) { write_file(filepath, {theirs->mode, theirs->hash}, result); }
+            continue;
+        }
+
+        if(!is_blob(ours) && !is_blob(theirs)) {
+            // A directory deleted on one side is walked against nothing, files modified on the other side conflict
+            merge_trees(is_tree(base) ? base->hash : "", is_tree(ours) ? ours->hash : "", is_tree(theirs) ? theirs->hash : "", filepath + "/", branch, result);
+        }
+        else if(is_blob(ours) && is_blob(theirs)) {
+            const File base_file = is_blob(base) ? File{base->mode, base->hash} : File{};
+            merge_file(filepath, is_blob(base) ? &base_file : nullptr, {ours->mode, ours->hash}, {theirs->mode, theirs->hash}, branch, result);
+        }
+        else {
+            // Deleted on one side and modified on the other, the modified file is kept for the user to decide.
+            // A file on one side and a directory on the other keeps the current branch's version.
+            if(ours == nullptr) { utils::create_file_from_blob(filepath, theirs->hash, theirs->mode); }
+            result.conflicted_files.insert(filepath);
+            utils::write(utils::CONFLICT, filepath);
         }
     }
+}
 
-    for(const std::pair<std::string, std::pair<std::string, std::string>>& p : commit_hash1_files) {
-        const std::string& filepath = p.first;
-        const std::string commit_hash1_file_mode = p.second.first; // mode
-        const std::string commit_hash1_file_hash = p.second.second; // blob_hash
+// The current branch is an ancestor of <branch>: the ref moves forward and only files that differ between the two commits are touched
+void fast_forward(const std::string& ours_tree_hash, const std::string& theirs_tree_hash, MergeResult& result) {
+    const std::vector<FileChange> changes = diff_engine::diff_trees(ours_tree_hash, theirs_tree_hash);
+    apply_changes(changes, result);
 
-        auto it = commit_hash2_files.find(filepath);
+    for(const FileChange& change : changes) {
+        if(change.new_file.second.empty()) { utils::write(utils::DELETED, utils::get_red_text(change.filepath)); }
+    }
+    for(const FileChange& change : changes) {
+        if(change.new_file.second.empty()) { continue; }
+        if(change.old_file.second.empty()) { utils::write(utils::NEW_FILE, utils::get_light_green_text(change.filepath)); }
+        else { utils::write(utils::MODIFIED, change.filepath); }
+    }
+}
+
+// Points the current branch at 'new_commit_hash' and records the move in its reflog
+void move_branch(const std::string& old_commit_hash, const std::string& new_commit_hash, const std::string& message) {
+    const std::string branch = utils::get_current_branch();
 
-        if(it == commit_hash2_files.end()) { continue; }
+    std::ofstream branch_file(config::REFS_HEAD_DIR + branch, std::ios::out | std::ios::trunc);
+    if (!branch_file) {
+        const std::string error_msg = "Failed to open file: " + config::REFS_HEAD_DIR + branch;
+        throw std::runtime_error(error_msg);
+    }
+    branch_file << new_commit_hash;
+    branch_file.close();
 
-        const std::string commit_hash2_file_mode = it->second.first; // mode
-        const std::string commit_hash2_file_hash = it->second.second; // blob_hash
+    std::ofstream log_file(config::LOG_REFS_HEAD_DIR + branch, std::ios::out | std::ios::app);
+    log_file << old_commit_hash << " " << new_commit_hash << " " << utils::get_username() << " " << utils::get_unix_timestamp() << " " << message << "\n";
+    log_file.close();
+}
 
-        if(commit_hash1_file_hash == commit_hash2_file_hash) { continue; }
+// Only the paths the merge touched are restaged, everything else keeps its index entry and stat data.
+// Files outside of the sparse checkout are staged without stat data of their own.
+// Conflicted files keep the current branch's entry, so they show up as modified. Directories outside of a sparse
+// checkout that match 'tree_hash' are collapsed again, none with an empty hash.
+void stage_merge_result(const MergeResult& result, const std::string& tree_hash) {
+    std::map<std::string, IndexEntry> index_entries;
+    utils::read_index(index_entries);
+    SparseCheckout::expand_index(index_entries);
 
-        std::vector<std::string> lines1, lines2;
-        utils::get_lines_from_blob(commit_hash1_file_hash, lines1);
-        utils::get_lines_from_blob(commit_hash2_file_hash, lines2);
+    for(const std::string& filepath : result.removed_files) { index_entries.erase(filepath); }
 
-        merge(lines1, lines2, filepath, branch);
+    for(const auto& [filepath, file] : result.written_files) {
+        const std::string size = std::to_string(utils::get_file_size(filepath));
+        index_entries[filepath] = IndexEntry(filepath, file.second, size, file.first, utils::get_mtime(filepath));
+    }
 
-        utils::write(utils::CONFLICT, filepath);
+    // No file on disk, the size comes from the blob's header
+    for(const auto& [filepath, file] : result.skip_worktree_files) {
+        const std::string size = std::to_string(ObjectStream(utils::get_object_path(file.second)).size());
+        index_entries[filepath] = IndexEntry(filepath, file.second, size, file.first, utils::get_current_timestamp());
     }
+
+    SparseCheckout().collapse_index(index_entries, tree_hash);
+    utils::write_index(index_entries);
 }
 
 void MergeCommand::execute(std::vector<std::string>& args) {
@@ -211,15 +291,54 @@ void MergeCommand::execute(std::vector<std::string>& args) {
     const std::string head_commit_hash1 = utils::get_commit_hash(utils::get_current_branch());
     const std::string head_commit_hash2 = utils::get_commit_hash(branch);
 
-    const std::string tree_hash1 = utils::get_tree_hash_from_commit(head_commit_hash1);
-    std::map<std::string, std::pair<std::string, std::string>> commit_hash1_files; // {file_path, blob_hash}
-    solve(tree_hash1, "", commit_hash1_files);
+    const bool has_commits = (head_commit_hash1 != std::string(40, '0') && head_commit_hash2 != std::string(40, '0'));
+    CommitGraph graph;
 
+    if(head_commit_hash2 == std::string(40, '0') || (has_commits && graph.is_ancestor(head_commit_hash2, head_commit_hash1))) {
+        utils::write(utils::OK, "Already up to date.");
+        return;
+    }
+
+    const bool is_fast_forward = !has_commits || graph.is_ancestor(head_commit_hash1, head_commit_hash2);
+
+    const std::string tree_hash1 = (head_commit_hash1 != std::string(40, '0')) ? utils::get_tree_hash_from_commit(head_commit_hash1) : "";
     const std::string tree_hash2 = utils::get_tree_hash_from_commit(head_commit_hash2);
-    std::map<std::string, std::pair<std::string, std::string>> commit_hash2_files; // {file_path, blob_hash}
-    solve(tree_hash2, "", commit_hash2_files);
+
+    MergeResult result;
+
+    if(is_fast_forward) {
+        utils::write(utils::INFO, "Updating", head_commit_hash1.substr(0, 7) + ".." + head_commit_hash2.substr(0, 7));
+
+        fast_forward(tree_hash1, tree_hash2, result);
+        stage_merge_result(result, tree_hash2);
+        move_branch(head_commit_hash1, head_commit_hash2, "merge " + branch + ": Fast-forward");
+
+        utils::write(utils::OK, "Fast-forward", head_commit_hash2);
+        return;
+    }
+
+    // Common ancestor of both branches, every change is measured against it
+    const std::string base_commit_hash = graph.get_merge_base(head_commit_hash1, head_commit_hash2);
+    const std::string base_tree_hash = base_commit_hash.empty() ? "" : utils::get_tree_hash_from_commit(base_commit_hash);
 
     // merge 1 <- 2
 
-    merge_branch(commit_hash1_files, commit_hash2_files, branch);
-}
\ No newline at end of file
+    if(!base_tree_hash.empty()) { merge_renames(base_tree_hash, tree_hash1, tree_hash2, branch, result); }
+    merge_trees(base_tree_hash, tree_hash1, tree_hash2, "", branch, result);
+
+    // The merged tree isn't known before the commit, which collapses the sparse index against it
+    stage_merge_result(result, "");
+
+    std::ofstream merge_head(config::MERGE_HEAD_FILE, std::ios::trunc);
+    merge_head << head_commit_hash2;
+    merge_head.close();
+
+    if(!result.conflicted_files.empty()) {
+        utils::write(utils::ERR, "Automatic merge failed; fix conflicts and then commit the result.");
+        utils::write(utils::INFO, "use \"vcs add <file>\" after resolving, then \"vcs commit <message>\"");
+        return;
+    }
+
+    const std::string merge_commit_hash = CommitCommand::create_commit("Merge branch '" + branch + "'");
+    utils::write(utils::OK, "Merge made by the three-way strategy.", merge_commit_hash);
+}
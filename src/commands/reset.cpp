@@ -67,8 +67,12 @@ void ResetCommand::validate(std::vector<std::string>& args) {
     }
 
     const std::string cur_branch = utils::get_current_branch();
+    const std::string branch_commit_hash = utils::get_commit_hash(cur_branch);
 
-    if(!utils::is_commit_exists_on_branch(cur_branch, commit_hash)) {
+    // History of the branch comes from the commit graph, the reflog still allows moving forward again after a reset
+    const bool is_on_branch = branch_commit_hash != std::string(40, '0') && CommitGraph().is_ancestor(commit_hash, branch_commit_hash);
+
+    if(!is_on_branch && !utils::is_commit_exists_on_branch(cur_branch, commit_hash)) {
         const std::string error_msg = "Commit hash " + commit_hash + " does not exist on branch '" + cur_branch + "'.";
         throw std::invalid_argument(error_msg);
     }
@@ -96,6 +100,33 @@ void ResetCommand::validate(std::vector<std::string>& args) {
 //     ofs.close();
 // }
 
+// Index of the target tree. Entries with the same blob and mode as before keep their stat data, for the others the
+// working file is compared so one that already has the target content gets its stat data as well.
+void reset_index(const std::string& tree_hash) {
+    const SparseCheckout sparse;
+    std::map<std::string, IndexEntry> old_entries, new_entries;
+    utils::read_index(old_entries);
+
+    std::stringstream buffer;
+    utils::solve(tree_hash, buffer, ""); // get all data from tree, sizes and mtimes as they were committed
+
+    std::string line;
+    while(std::getline(buffer, line)) {
+        std::istringstream line_stream(line);
+        IndexEntry entry;
+        if(!(line_stream >> entry.filepath >> entry.hash >> entry.size >> entry.mode >> entry.mtime)) { continue; }
+
+        auto it = old_entries.find(entry.filepath);
+        if(it != old_entries.end() && it->second.hash == entry.hash && it->second.mode == entry.mode) { entry = it->second; }
+        else if(!sparse.is_skip_worktree(entry.filepath)) { utils::refresh_index_entry(entry); }
+
+        new_entries[entry.filepath] = entry;
+    }
+
+    sparse.collapse_index(new_entries, tree_hash);
+    utils::write_index(new_entries);
+}
+
 void mixed_reset(const std::string& commit_hash) {
     // This will directly go to the commit point just like 'checkout' but do not touch the working directory, and also removes commit logs, means same stagging area where it was at "commit".
     const std::string cur_branch = utils::get_current_branch();
@@ -110,13 +141,7 @@ void mixed_reset(const std::string& commit_hash) {
         throw std::logic_error(error_msg);
     }
 
-    std::stringstream buffer;
-    utils::solve(tree_hash, buffer, ""); // get all data from tree and put into the index files
-
-    std::string compressed = utils::compress_zlib(buffer.str());
-    std::ofstream ofs(config::INDEX_FILE, std::ios::binary | std::ios::trunc);
-    ofs.write(compressed.data(), compressed.size());
-    ofs.close();
+    reset_index(tree_hash); // only entries that differ from the target lose their stat data
 
     std::ofstream out(cur_branch_path, std::ios::out | std::ios::trunc);
 
@@ -163,17 +188,7 @@ void hard_reset(const std::string& commit_hash) {
     
     warning_hard_reset();
 
-    std::stringstream buffer;
-    utils::solve(tree_hash, buffer, ""); // adds the last commit's tree to the index file(staging area) and removes all current files.
-    
-    std::string compressed = utils::compress_zlib(buffer.str());
-    std::ofstream ofs_index(config::INDEX_FILE, std::ios::binary | std::ios::trunc);
-    ofs_index.write(compressed.data(), compressed.size());
-    ofs_index.close();
-
-    utils::clean_working_directory();
-
-    utils::make_checkout();
+    utils::checkout_tree(utils::get_head_tree_hash(), tree_hash); // only files that differ from HEAD (or were changed locally) are rewritten, the index follows.
 
     std::ofstream ofs_head(cur_branch_path, std::ios::out | std::ios::trunc);
 
@@ -0,0 +1,123 @@
+#include "commands/sparse-checkout.hpp"
+
+void SparseCheckoutCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs sparse-checkout set <dir>...");
+    utils::write(utils::INFO, "usage : vcs sparse-checkout add <dir>...");
+    utils::write(utils::INFO, "usage : vcs sparse-checkout list");
+    utils::write(utils::INFO, "usage : vcs sparse-checkout disable");
+    utils::write(utils::INFO, "flag  : --sparse-index    (set/add: keep each directory outside of the cones as one index entry)");
+    utils::write(utils::INFO, "flag  : --no-sparse-index (set/add: list every file in the index again)");
+    utils::write(utils::EMPTY);
+}
+
+void SparseCheckoutCommand::validate(std::vector<std::string>& args) {
+    if(args.empty()) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    this->subcommand = args[0];
+    for(size_t i = 1; i < args.size(); ++i) {
+        if(args[i] == "--sparse-index" || args[i] == "--no-sparse-index") { this->sparse_index_flag = args[i]; }
+        else { this->dirs.push_back(args[i]); }
+    }
+
+    if(this->subcommand == "set" || this->subcommand == "add") {
+        if(this->dirs.empty()) {
+            const std::string error_msg = "Too few arguments";
+            throw std::invalid_argument(error_msg);
+        }
+
+        for(std::string& dir : this->dirs) {
+            if(dir.rfind("./", 0) == 0) { dir = dir.substr(2); }
+            if(dir.empty() || dir[0] == '/' || dir == "." || dir.find("..") != std::string::npos) {
+                const std::string error_msg = "Invalid directory: '" + dir + "'. Expected a path relative to the repository root.";
+                throw std::invalid_argument(error_msg);
+            }
+        }
+        return;
+    }
+
+    if(this->subcommand != "list" && this->subcommand != "disable") {
+        const std::string error_msg = "Invalid subcommand: " + this->subcommand + ". Expected set, add, list, or disable";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(!this->dirs.empty() || !this->sparse_index_flag.empty()) {
+        const std::string error_msg = "Too many arguments";
+        throw std::invalid_argument(error_msg);
+    }
+}
+
+void SparseCheckoutCommand::apply(const SparseCheckout& old_sparse, const SparseCheckout& new_sparse) {
+    std::map<std::string, IndexEntry> index_entries;
+    if(utils::is_file_exist(config::INDEX_FILE)) { utils::read_index(index_entries); }
+    SparseCheckout::expand_index(index_entries);
+
+    std::vector<std::pair<std::string, std::pair<std::string, std::string>>> files;
+
+    for(auto& [filepath, entry] : index_entries) {
+        const bool was_skipped = old_sparse.is_skip_worktree(filepath);
+        const bool is_skipped = new_sparse.is_skip_worktree(filepath);
+
+        if(was_skipped && !is_skipped) {
+            files.push_back({filepath, {entry.mode, entry.hash}});
+            continue;
+        }
+
+        if(!was_skipped && is_skipped) {
+            // A file with local changes stays where it is, it's only removed once it matches the index again
+            IndexEntry refreshed = entry;
+            if(fs::exists(filepath) && !utils::refresh_index_entry(refreshed)) {
+                utils::write(utils::WARN, "Not removing '" + filepath + "', it has local changes.");
+                continue;
+            }
+            utils::remove_worktree_file(filepath);
+        }
+    }
+
+    for(const IndexEntry& entry : utils::write_worktree_files(files)) { index_entries[entry.filepath] = entry; }
+
+    new_sparse.collapse_index(index_entries, utils::get_head_tree_hash());
+    utils::write_index(index_entries);
+}
+
+void SparseCheckoutCommand::execute(std::vector<std::string>& args) {
+    const SparseCheckout old_sparse;
+
+    if(this->subcommand == "list") {
+        if(!old_sparse.enabled()) {
+            utils::write(utils::INFO, "Sparse checkout is not enabled.");
+            return;
+        }
+        for(const std::string& dir : old_sparse.get_cone_dirs()) { utils::write(utils::CONTENT, dir); }
+        if(old_sparse.sparse_index()) { utils::write(utils::INFO, "Sparse index is enabled."); }
+        return;
+    }
+
+    if(this->subcommand == "disable") {
+        if(!old_sparse.enabled()) {
+            utils::write(utils::INFO, "Sparse checkout is not enabled.");
+            return;
+        }
+
+        const SparseCheckout new_sparse(std::vector<std::string>{}, false);
+        apply(old_sparse, new_sparse);
+        new_sparse.save();
+
+        utils::write(utils::OK, "Sparse checkout disabled.");
+        return;
+    }
+
+    std::vector<std::string> dirs = this->dirs;
+    if(this->subcommand == "add") { dirs.insert(dirs.end(), old_sparse.get_cone_dirs().begin(), old_sparse.get_cone_dirs().end()); }
+
+    SparseCheckout new_sparse(dirs);
+    new_sparse.set_sparse_index(this->sparse_index_flag.empty() ? old_sparse.sparse_index() : this->sparse_index_flag == "--sparse-index");
+    apply(old_sparse, new_sparse);
+    new_sparse.save();
+
+    utils::write(utils::OK, "Sparse checkout set to", std::to_string(new_sparse.get_cone_dirs().size()), "directories.");
+}
@@ -240,9 +240,15 @@ void stash_it(const std::string& stash_message) {
 
     traverse(".", tree, ignore_list);
 
-    // push index file also
-    const std::string index_compressed_data = utils::read_and_decompress(config::INDEX_FILE);
-    std::stringstream index_buffer(index_compressed_data);
+    // push index file also, with every file: directories of a sparse index only hold against the current HEAD
+    std::map<std::string, IndexEntry> index_entries;
+    utils::read_index(index_entries);
+    SparseCheckout::expand_index(index_entries);
+
+    std::stringstream index_buffer;
+    for (const auto& [filepath, entry] : index_entries) {
+        index_buffer << filepath << " " << entry.hash << " " << entry.size << " " << entry.mode << " " << entry.mtime << "\n";
+    }
     const std::string index_hash = HashObjectCommand::write_obj(index_buffer, "blob"); // create blob object
 
     std::string tree_entry = add_for_commit(tree.root, true, ".");
@@ -281,10 +287,16 @@ void stash_it(const std::string& stash_message) {
     std::stringstream new_index_buffer;
     utils::solve(prev_tree_hash, new_index_buffer, ""); // get all data from tree and put into the index files
 
-    const std::string compressed = utils::compress_zlib(new_index_buffer.str());
-    std::ofstream ofs(config::INDEX_FILE, std::ios::binary | std::ios::trunc);
-    ofs.write(compressed.data(), compressed.size());
-    ofs.close();
+    std::map<std::string, IndexEntry> new_index_entries;
+    std::string line;
+    while (std::getline(new_index_buffer, line)) {
+        std::istringstream line_stream(line);
+        IndexEntry entry;
+        if (line_stream >> entry.filepath >> entry.hash >> entry.size >> entry.mode >> entry.mtime) { new_index_entries[entry.filepath] = entry; }
+    }
+
+    SparseCheckout().collapse_index(new_index_entries, prev_tree_hash);
+    utils::write_index(new_index_entries);
 
     utils::clean_working_directory();
 
@@ -342,7 +354,7 @@ void StashCommand::solve(const std::string& tree_hash, std::string path, std::ma
         iss >> mode >> type >> hash >> mtime >> size >> file_name;
 
         if (type == "tree") {
-            solve(hash, file_name + "/", last_commit_files); // Recursive call for sub-trees
+            solve(hash, path + file_name + "/", last_commit_files); // Recursive call for sub-trees
         } else if (type == "blob") {
             const std::string filepath = path + file_name;
             last_commit_files[filepath] = {mode, hash}; 
@@ -480,29 +492,10 @@ void merge_it(const std::map<std::string, std::pair<std::string, std::string>>&
 }
 
 void put_data_in_index(const std::string& index_file_hash) {    
-    // Map: filepath -> tuple(hash, size, mode, mtime)
-    std::map<std::string, std::tuple<std::string, std::string, std::string, std::time_t>> index_map;
-
-    // Read and decompress the existing index file
-    const std::string latest_index_decompressed_data = utils::read_and_decompress(config::INDEX_FILE);
-
-    std::istringstream iss_latest(latest_index_decompressed_data);
-    std::string line_latest;
-    while (std::getline(iss_latest, line_latest)) {
-        if (line_latest.empty()) continue;  // <-- Corrected: skip empty lines
-
-        std::istringstream line_stream(line_latest);
-        std::string filepath, hash, size, mode;
-        std::time_t mtime;
-
-        // Parse the line, check if all fields are present
-        if (!(line_stream >> filepath >> hash >> size >> mode >> mtime)) {
-            // Handle malformed line if needed
-            continue;
-        }
-
-        index_map[filepath] = {hash, size, mode, mtime};
-    }
+    // Both indexes with every file, directory entries of the sparse index are collapsed again once they're merged
+    std::map<std::string, IndexEntry> index_entries, stash_index_entries;
+    utils::read_index(index_entries);
+    SparseCheckout::expand_index(index_entries);
 
     // Read and decompress the new index blob data
     std::string index_decompressed_data = utils::read_and_decompress(utils::get_object_path(index_file_hash));
@@ -523,37 +516,28 @@ void put_data_in_index(const std::string& index_file_hash) {
         if (line.empty()) continue; 
 
         std::istringstream line_stream(line);
-        std::string filepath, hash, size, mode;
-        std::time_t mtime;
+        IndexEntry entry;
 
-        if (!(line_stream >> filepath >> hash >> size >> mode >> mtime)) {
+        if (!(line_stream >> entry.filepath >> entry.hash >> entry.size >> entry.mode >> entry.mtime)) {
             // Handle malformed line if needed
             continue;
         }
 
-        // Insert only if filepath not already in index_map
-        if (index_map.find(filepath) == index_map.end()) {
-            index_map[filepath] = {hash, size, mode, mtime};
-        }
+        stash_index_entries[entry.filepath] = entry;
     }
 
-    // Serialize the updated index map back into a string
-    std::ostringstream oss;
-    for (const auto& [filepath, data] : index_map) {
-        const auto& [hash, size, mode, mtime] = data;
-        oss << filepath << " " << hash << " " << size << " " << mode << " " << mtime << "\n";
+    // Stashes saved before the index was expanded on save may still have directory entries
+    SparseCheckout::expand_index(stash_index_entries);
+
+    // Insert only if filepath not already in the index
+    for (const auto& [filepath, entry] : stash_index_entries) {
+        index_entries.try_emplace(filepath, entry);
     }
 
-    // Compress the serialized string
-    const std::string compressed_index_file = utils::compress_zlib(oss.str());
+    const std::string head_tree_hash = utils::get_head_tree_hash();
+    if (!head_tree_hash.empty()) { SparseCheckout().collapse_index(index_entries, head_tree_hash); }
 
-    // Write compressed data back to index file
-    std::ofstream index_file(config::INDEX_FILE, std::ios::binary | std::ios::trunc);
-    if (!index_file) {
-        const std::string error_msg = "Failed to open index file for writing: " + config::INDEX_FILE; 
-        throw std::runtime_error(error_msg);
-    }
-    index_file.write(compressed_index_file.data(), compressed_index_file.size());
+    utils::write_index(index_entries);
 }
 
 void StashCommand::stash_apply(const std::string& tag) {
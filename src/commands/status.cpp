@@ -11,22 +11,28 @@ void StatusCommand::validate(std::vector<std::string>& args) {
     }
 }
 
-void StatusCommand::process_file(const fs::path& path, const std::map<std::string, std::pair<std::string, std::string>>& index_map) {
-    if(index_map.find(path.string()) == index_map.end()) {
+void StatusCommand::process_file(const fs::path& path, const std::map<std::string, IndexEntry>& index_map) {
+    auto it = index_map.find(path.string());
+    if(it == index_map.end()) {
         this->untracked_files.push_back(path.string());
-    } else {
-        const std::string mode = utils::get_file_mode(path.string());
-        const std::string hash = utils::sha1(utils::read_file_content(path.string()));
-        std::pair<std::string, std::string> p = {mode, hash};
-
-        auto it = index_map.find(path.string());
-        if(it != index_map.end() && p != it->second) {
-            this->modified_files.push_back(path.string());
-        }
+        return;
+    }
+
+    const IndexEntry& entry = it->second;
+    const std::string mode = utils::get_file_mode(path.string());
+    const bool is_same_mode = (mode == entry.mode);
+
+    // Unchanged stat data means unchanged content, no need to read the file. Entries written in the same second as
+    // the index can't be trusted by mtime alone (racy entries).
+    if(is_same_mode && std::to_string(utils::get_file_size(path.string())) == entry.size && utils::get_mtime(path.string()) == entry.mtime && entry.mtime < this->index_mtime) { return; }
+
+    const std::string hash = utils::sha1(utils::read_file_content(path.string()));
+    if(!is_same_mode || hash != entry.hash) {
+        this->modified_files.push_back(path.string());
     }
 }
 
-void StatusCommand::iterate_directory(const fs::path& path, const std::set<std::string>& ignore_list, const std::map<std::string, std::pair<std::string, std::string>>& index_map) {
+void StatusCommand::iterate_directory(const fs::path& path, const std::set<std::string>& ignore_list, const std::map<std::string, IndexEntry>& index_map) {
     for (const auto& entry : fs::directory_iterator(path)) {
         if (utils::is_ignored(entry.path(), entry.is_directory(), ignore_list)) continue;
 
@@ -40,29 +46,18 @@ void StatusCommand::iterate_directory(const fs::path& path, const std::set<std::
 }
 
 void StatusCommand::check_status(){
-    std::string decompressed_data = utils::read_and_decompress(config::INDEX_FILE);
-
-    std::map<std::string, std::pair<std::string, std::string>> index_map;
-
-    // Decompress and load existing index 
-    if (!decompressed_data.empty()) {
-        std::istringstream iss(decompressed_data);
-        std::string line;
-        while (std::getline(iss, line)) {
-            std::istringstream line_stream(line);
-            std::string file_path, hash, size, mode, mtime;
-            line_stream >> file_path >> hash >> size >> mode >> mtime;
-            index_map[file_path] = {mode, hash};    
-        }
+    std::map<std::string, IndexEntry> index_map;
+    if(utils::is_file_exist(config::INDEX_FILE)) {
+        utils::read_index(index_map);
+        this->index_mtime = utils::get_mtime(config::INDEX_FILE);
     }
 
     const std::set<std::string> ignore_list = utils::load_ignore_list();
     iterate_directory(".", ignore_list, index_map);
 
-    for(const std::pair<std::string, std::pair<std::string, std::string>>& p : index_map) {
-        const std::string& filepath = p.first;
-
-        if(!fs::exists(filepath)) {
+    const SparseCheckout sparse;
+    for(const auto& [filepath, entry] : index_map) {
+        if(!sparse.is_skip_worktree(filepath) && !fs::exists(filepath)) {
             this->deleted_files.push_back(filepath);
         }
     }
@@ -129,7 +124,7 @@ void StatusCommand::get_index_files(std::map<std::string, std::pair<std::string,
     }
 }
 
-void StatusCommand::solve(const std::string& tree_hash, std::string path, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files) {
+void StatusCommand::solve(const std::string& tree_hash, std::string path, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, const std::map<std::string, std::pair<std::string, std::string>>& index_files) {
     const std::string tree_content = utils::read_and_decompress(utils::get_object_path(tree_hash));
 
     // ./main.out ls-tree 6725736609ced67ff91c01194131fb5c1e96b795
@@ -152,7 +147,13 @@ void StatusCommand::solve(const std::string& tree_hash, std::string path, std::m
         iss >> mode >> type >> hash >> mtime >> size >> file_name;
 
         if (type == "tree") {
-            solve(hash, file_name + "/", last_commit_files); // Recursive call for sub-trees
+            // A directory the sparse index has as one entry is compared as one entry while it's unchanged
+            auto it = index_files.find(path + file_name + "/");
+            if (it != index_files.end() && it->second.second == hash) {
+                last_commit_files[it->first] = it->second;
+                continue;
+            }
+            solve(hash, path + file_name + "/", last_commit_files, index_files); // Recursive call for sub-trees
         } else if (type == "blob") {
             const std::string filepath = path + file_name;
             last_commit_files[filepath] = {mode, hash}; 
@@ -160,16 +161,46 @@ void StatusCommand::solve(const std::string& tree_hash, std::string path, std::m
     }
 }
 
-void StatusCommand::get_last_commit_files(std::map<std::string, std::pair<std::string, std::string>>& last_commit_files) {
+void StatusCommand::get_last_commit_files(std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, std::map<std::string, std::pair<std::string, std::string>>& index_files) {
     const std::string head_commit_hash = utils::get_head_commit_hash();
     if(head_commit_hash == std::string(40, '0')) return;
 
     const std::string tree_hash = utils::get_tree_hash_from_commit(head_commit_hash);
 
-    solve(tree_hash, "", last_commit_files);
+    solve(tree_hash, "", last_commit_files, index_files);
+
+    // Directory entries that don't match the commit are compared file by file
+    for(auto it = index_files.begin(); it != index_files.end();) {
+        if(it->second.first != "040000" || last_commit_files.count(it->first)) {
+            ++it;
+            continue;
+        }
+
+        std::stringstream buffer;
+        utils::solve(it->second.second, buffer, it->first);
+        it = index_files.erase(it);
+
+        std::string line;
+        while(std::getline(buffer, line)) {
+            std::istringstream line_stream(line);
+            std::string file_path, blob_hash, size, mode;
+            if(line_stream >> file_path >> blob_hash >> size >> mode) { index_files.emplace(file_path, std::make_pair(mode, blob_hash)); }
+        }
+    }
 }
 
 void StatusCommand::compare_staged_and_last_commit(std::map<std::string, std::pair<std::string, std::string>>& index_files, std::map<std::string, std::pair<std::string, std::string>>& last_commit_files, std::vector<std::pair<FileState, std::string>>& changes) {
+    std::map<std::string, std::pair<std::string, std::string>> deleted_files, added_files, modified_files;
+    diff_engine::split_changes(last_commit_files, index_files, deleted_files, added_files, modified_files);
+
+    // A moved file is one rename instead of a new file plus a deleted file
+    std::set<std::string> rename_targets, renamed_sources;
+    for(const RenameMatch& rename : diff_engine::detect_renames(deleted_files, added_files, modified_files)) {
+        changes.push_back({rename.is_copy ? FileState::COPIED : FileState::RENAMED, rename.old_path + " -> " + rename.new_path});
+        rename_targets.insert(rename.new_path);
+        if(!rename.is_copy) { renamed_sources.insert(rename.old_path); }
+    }
+
     for(const std::pair<std::string, std::pair<std::string, std::string>>& p : index_files) {
         const std::string& filepath = p.first;
         const std::string& index_new_file_mode = p.second.first; // mode
@@ -178,7 +209,7 @@ void StatusCommand::compare_staged_and_last_commit(std::map<std::string, std::pa
         auto it = last_commit_files.find(filepath);  
         
         if(it == last_commit_files.end()) {
-            changes.push_back({FileState::NEW_FILE, filepath});
+            if(rename_targets.count(filepath) == 0) changes.push_back({FileState::NEW_FILE, filepath});
             continue;
         }
 
@@ -201,16 +232,22 @@ void StatusCommand::compare_staged_and_last_commit(std::map<std::string, std::pa
 
         auto it = index_files.find(filepath);
 
-        if(it == index_files.end()) {
+        if(it == index_files.end() && renamed_sources.count(filepath) == 0) {
             changes.push_back({FileState::DELETED, filepath});
         }
     }
 }
 
 void StatusCommand::print_changes(const std::vector<std::pair<FileState, std::string>>& changes) {
-    std::vector<std::string> new_files, modified_files, deleted_files;
+    std::vector<std::string> new_files, modified_files, deleted_files, renamed_files, copied_files;
     for (const auto& change : changes) {
         switch (change.first) {
+            case FileState::RENAMED:
+                renamed_files.push_back(change.second);
+                break;
+            case FileState::COPIED:
+                copied_files.push_back(change.second);
+                break;
             case FileState::NEW_FILE:
                 new_files.push_back(change.second);
                 break;
@@ -234,6 +271,16 @@ void StatusCommand::print_changes(const std::vector<std::pair<FileState, std::st
         utils::write(utils::STATUS, "Modified files to be committed:");
         for (const auto& file : modified_files) utils::write(utils::MODIFIED, utils::get_light_green_text(file));
     }
+    if (!renamed_files.empty()) {
+        utils::write(utils::EMPTY);
+        utils::write(utils::STATUS, "Renamed files to be committed:");
+        for (const auto& file : renamed_files) utils::write(utils::RENAMED, utils::get_light_green_text(file));
+    }
+    if (!copied_files.empty()) {
+        utils::write(utils::EMPTY);
+        utils::write(utils::STATUS, "Copied files to be committed:");
+        for (const auto& file : copied_files) utils::write(utils::COPIED, utils::get_light_green_text(file));
+    }
     if (!deleted_files.empty()) {
         utils::write(utils::EMPTY);
         utils::write(utils::STATUS, "Deleted files:");
@@ -246,7 +293,7 @@ bool StatusCommand::is_working_tree_clean() {
     get_index_files(index_files);
 
     std::map<std::string, std::pair<std::string, std::string>> last_commit_files; // {file_path, blob_hash}
-    if(utils::get_head_commit_hash() != std::string(40, '0')) get_last_commit_files(last_commit_files);
+    if(utils::get_head_commit_hash() != std::string(40, '0')) get_last_commit_files(last_commit_files, index_files);
 
     std::vector<std::pair<FileState, std::string>> changes;
 
@@ -269,7 +316,7 @@ void StatusCommand::print_status() {
     get_index_files(index_files);
 
     std::map<std::string, std::pair<std::string, std::string>> last_commit_files; // {file_path, blob_hash}
-    get_last_commit_files(last_commit_files);
+    get_last_commit_files(last_commit_files, index_files);
 
     std::vector<std::pair<FileState, std::string>> changes;
 
@@ -0,0 +1,135 @@
+#include "commands/worktree.hpp"
+
+void WorktreeCommand::help()
+{
+    utils::write(utils::EMPTY);
+    utils::write(utils::INFO, "usage : vcs worktree add <path> <branch-name>");
+    utils::write(utils::INFO, "usage : vcs worktree list");
+    utils::write(utils::EMPTY);
+}
+
+void WorktreeCommand::validate(std::vector<std::string>& args) {
+    if(args.empty()) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    this->subcommand = args[0];
+    const int args_size = args.size();
+
+    if(this->subcommand == "list") {
+        if(args_size > 1) {
+            const std::string error_msg = "Too many arguments";
+            throw std::invalid_argument(error_msg);
+        }
+        return;
+    }
+
+    if(this->subcommand != "add") {
+        const std::string error_msg = "Invalid subcommand: " + this->subcommand + ". Expected add or list";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(args_size < 3) {
+        const std::string error_msg = "Too few arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(args_size > 3) {
+        const std::string error_msg = "Too many arguments";
+        throw std::invalid_argument(error_msg);
+    }
+
+    const std::string& path = args[1];
+    const std::string& branch = args[2];
+
+    if(fs::exists(path) && (!fs::is_directory(path) || !fs::is_empty(path))) {
+        const std::string error_msg = "Invalid path: '" + path + "' already exists and is not an empty directory.";
+        throw std::invalid_argument(error_msg);
+    }
+
+    if(!utils::is_valid_branch_name(branch) || !utils::is_file_exist(config::REFS_HEAD_DIR + branch)) {
+        const std::string error_msg = "Invalid arguments: branch '" + branch + "' does not exist.";
+        throw std::invalid_argument(error_msg);
+    }
+
+    // Two worktrees on one branch would each move it under the other's feet
+    const std::string worktree_path = utils::find_branch_worktree(branch);
+    if(!worktree_path.empty()) {
+        const std::string error_msg = "Branch '" + branch + "' is already checked out at '" + worktree_path + "'.";
+        throw std::invalid_argument(error_msg);
+    }
+}
+
+void WorktreeCommand::add_worktree(const std::string& path, const std::string& branch) {
+    const fs::path worktree_path = fs::absolute(path).lexically_normal();
+    const fs::path main_vcs_dir = fs::canonical(config::OBJECTS_DIR).parent_path();
+
+    if(utils::create_directory(config::WORKTREES_DIR) == utils::DIR_STATUS::ERROR) {
+        const std::string error_msg = "Failed to create directory: " + config::WORKTREES_DIR;
+        throw std::runtime_error(error_msg);
+    }
+
+    fs::create_directories(worktree_path / config::VCS_DIR);
+    for(const char* shared_dir : {"objects", "refs", "logs", "worktrees"}) {
+        fs::create_directory_symlink(main_vcs_dir / shared_dir, worktree_path / config::VCS_DIR / shared_dir);
+    }
+
+    // The commit-graph, its filters and the bitmaps describe the shared history. Linked even before they exist, the
+    // writers replace the file the link points at.
+    for(const std::string& shared_file : {config::COMMIT_GRAPH_FILE, config::BLOOM_FILE, config::BITMAP_FILE}) {
+        const std::string file_name = fs::path(shared_file).filename().string();
+        fs::create_symlink(main_vcs_dir / file_name, worktree_path / config::VCS_DIR / file_name);
+    }
+
+    // .vcs/worktrees/<name> points at the worktree, a name already taken gets a number
+    std::string name = worktree_path.filename().string();
+    for(int i = 1; fs::exists(config::WORKTREES_DIR + name); ++i) { name = worktree_path.filename().string() + std::to_string(i); }
+
+    std::ofstream registry_file(config::WORKTREES_DIR + name, std::ios::out | std::ios::trunc);
+    if(!registry_file) {
+        const std::string error_msg = "Failed to open file: " + config::WORKTREES_DIR + name;
+        throw std::runtime_error(error_msg);
+    }
+    registry_file << worktree_path.string();
+    registry_file.close();
+
+    std::ofstream head_file(worktree_path / config::HEAD_FILE, std::ios::out | std::ios::trunc);
+    if(!head_file) {
+        const std::string error_msg = "Failed to open file: " + (worktree_path / config::HEAD_FILE).string();
+        throw std::runtime_error(error_msg);
+    }
+    head_file << "ref: refs/heads/" << branch;
+    head_file.close();
+
+    // The files and the index are written from inside the new worktree
+    const std::string commit_hash = utils::get_commit_hash(branch);
+    {
+        utils::RepositoryScope worktree_scope(worktree_path);
+        if(commit_hash == std::string(40, '0')) { utils::write_index({}); }
+        else { utils::checkout_tree("", utils::get_tree_hash_from_commit(commit_hash)); }
+    }
+
+    utils::write(utils::OK, "Prepared worktree at '" + worktree_path.string() + "' on branch '" + branch + "'.");
+}
+
+void WorktreeCommand::list_worktrees() {
+    for(const std::string& worktree_path : utils::get_worktree_paths()) {
+        const std::string head_content = utils::read_file_content(worktree_path + "/" + config::HEAD_FILE);
+
+        if(head_content.find("ref: ") == std::string::npos) {
+            utils::write(utils::CONTENT, worktree_path, head_content.substr(0, 7), "(detached HEAD)");
+            continue;
+        }
+
+        const std::string branch = utils::extract_ref_branch(head_content);
+        utils::write(utils::CONTENT, worktree_path, utils::get_commit_hash(branch).substr(0, 7), "[" + branch + "]");
+    }
+}
+
+void WorktreeCommand::execute(std::vector<std::string>& args) {
+    utils::create_vcs_structure();
+
+    if(this->subcommand == "add") { add_worktree(args[1], args[2]); }
+    else { list_worktrees(); }
+}
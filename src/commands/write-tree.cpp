@@ -27,6 +27,13 @@ void WriteTreeCommand::validate(std::vector<std::string>& args) {
 std::string solve(Node* root, bool is_status_flag, std::string path) {
     if (root == NULL) return "";
 
+    // Directory the sparse index keeps as a single entry, its tree is written already
+    if(root->children.empty() && SparseCheckout::is_sparse_dir(root->index_entry)) {
+        const std::string entry = "040000 tree " + root->index_entry.hash + " " + std::to_string(root->index_entry.mtime) + " " + root->index_entry.size + " ";
+        if(is_status_flag) utils::write(utils::CREATED, entry + path);
+        return entry + root->fs_name;
+    }
+
     if(root->children.empty()) { // leaf-node
         const std::string blob_entry = root->index_entry.mode + " blob " + root->index_entry.hash + " " + std::to_string(root->index_entry.mtime) + " " + root->index_entry.size + " " + root->fs_name;
         return blob_entry;
@@ -0,0 +1,546 @@
+#include "commit_graph.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "diff_engine.hpp"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <queue>
+#include <tuple>
+
+namespace {
+    // Layout of .vcs/commit-graph, integers are big-endian:
+    //   header  "VCSG", version, row count, reserved               4 x 4 bytes
+    //   fanout  rows whose id starts with a byte <= i, i = 0..255  256 x 4 bytes
+    //   rows    id, tree id, parent1, parent2 (row numbers),        64 bytes each, sorted by id
+    //           commit time (8 bytes), generation, reserved
+    const char GRAPH_SIGNATURE[4] = {'V', 'C', 'S', 'G'};
+    const uint32_t GRAPH_VERSION  = 1;
+    const std::size_t HEADER_SIZE = 16;
+    const std::size_t FANOUT_SIZE = 256 * 4;
+    const std::size_t ROW_SIZE    = 64;
+    const std::size_t ID_SIZE     = 20;
+    const uint32_t NO_PARENT      = 0xFFFFFFFF;
+
+    // Layout of .vcs/commit-graph-bloom, rows are those of the commit graph:
+    //   header  "VCSB", version, row count, reserved                  4 x 4 bytes
+    //   ends    end offset of each row's filter in the data            row count x 4 bytes
+    //   data    filters of the paths changed against the first parent, directories included
+    const char BLOOM_SIGNATURE[4] = {'V', 'C', 'S', 'B'};
+    const uint32_t BLOOM_VERSION  = 1;
+
+    const unsigned char* map_file(const std::string& path, std::size_t& length) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) { return nullptr; }
+
+        const unsigned char* data = nullptr;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size >= off_t(HEADER_SIZE)) {
+            void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(mapped);
+                length = st.st_size;
+            }
+        }
+        close(fd); // the mapping outlives the descriptor
+
+        return data;
+    }
+
+    void unmap_file(const unsigned char*& data, std::size_t& length) {
+        if (data != nullptr) { munmap(const_cast<unsigned char*>(data), length); }
+        data = nullptr;
+        length = 0;
+    }
+
+    // Two independent FNV-1a hashes of the path, combined into the filter's probes
+    void get_bloom_hashes(const std::string& path, uint32_t& hash1, uint32_t& hash2) {
+        hash1 = 2166136261u;
+        hash2 = 0x9e3779b9u;
+        for (const unsigned char c : path) {
+            hash1 = (hash1 ^ c) * 16777619u;
+            hash2 = (hash2 ^ c) * 0x01000193u + 0x7f4a7c15u;
+        }
+        hash2 |= 1;
+    }
+
+    std::string make_filter(const std::set<std::string>& paths) {
+        if (paths.size() > config::BLOOM_MAX_PATHS) { return std::string(1, char(0xFF)); } // always "maybe"
+
+        const std::size_t bytes = std::max<std::size_t>(1, (paths.size() * config::BLOOM_BITS_PER_PATH + 7) / 8);
+        std::string filter(bytes, '\0');
+
+        for (const std::string& path : paths) {
+            uint32_t hash1, hash2;
+            get_bloom_hashes(path, hash1, hash2);
+            for (int i = 0; i < config::BLOOM_PROBES; i++) {
+                const uint32_t bit = (hash1 + uint32_t(i) * hash2) % (bytes * 8);
+                filter[bit / 8] = char((unsigned char)filter[bit / 8] | (1 << (bit % 8)));
+            }
+        }
+        return filter;
+    }
+
+    bool filter_contains(const std::string& filter, const std::string& path) {
+        if (filter.empty()) { return true; }
+
+        uint32_t hash1, hash2;
+        get_bloom_hashes(path, hash1, hash2);
+        for (int i = 0; i < config::BLOOM_PROBES; i++) {
+            const uint32_t bit = (hash1 + uint32_t(i) * hash2) % (filter.size() * 8);
+            if (!((unsigned char)filter[bit / 8] & (1 << (bit % 8)))) { return false; }
+        }
+        return true;
+    }
+
+    // Filter of every file and directory that differs between a commit's tree and its first parent's
+    std::string compute_filter(const std::string& tree_hash, const std::string& parent_tree_hash) {
+        std::set<std::string> paths;
+        for (const FileChange& change : diff_engine::diff_trees(parent_tree_hash, tree_hash)) {
+            std::string path = change.filepath;
+            while (!path.empty() && paths.insert(path).second) {
+                const std::size_t slash = path.find_last_of('/');
+                path = (slash == std::string::npos) ? "" : path.substr(0, slash);
+            }
+        }
+        return make_filter(paths);
+    }
+
+    CommitNode parse_commit(const std::string& commit_hash) {
+        const std::string commit_content = utils::read_and_decompress(utils::get_object_path(commit_hash));
+
+        CommitNode node{"", {}, 0, 0};
+
+        std::istringstream iss(commit_content);
+        std::string line;
+        std::getline(iss, line); // Read the first line (commit 213)
+
+        while (std::getline(iss, line)) {
+            if (line.rfind("tree ", 0) == 0) { node.tree_hash = line.substr(5); }
+            else if (line.rfind("parent ", 0) == 0) {
+                const std::string parent_hash = line.substr(7);
+                if (parent_hash != std::string(40, '0')) { node.parents.push_back(parent_hash); }
+            }
+            else if (line.rfind("author ", 0) == 0) {}
+            else if (line.rfind("committer ", 0) == 0) {
+                node.time = std::stoll(line.substr(line.find_last_of(' ') + 1));
+                break; // the message follows
+            }
+        }
+
+        return node;
+    }
+}
+
+CommitGraphFile::CommitGraphFile() {
+    data = map_file(config::COMMIT_GRAPH_FILE, length);
+    if (data == nullptr) { return; }
+
+    // A file from another version or cut short is ignored, the next commit writes a new one
+    count = utils::read_u32(data + 8);
+    if (length < HEADER_SIZE + FANOUT_SIZE || std::memcmp(data, GRAPH_SIGNATURE, 4) != 0 || utils::read_u32(data + 4) != GRAPH_VERSION || length != HEADER_SIZE + FANOUT_SIZE + std::size_t(count) * ROW_SIZE) {
+        unmap_file(data, length);
+        count = 0;
+        return;
+    }
+
+    bloom_data = map_file(config::BLOOM_FILE, bloom_length);
+    if (bloom_data == nullptr) { return; }
+
+    const std::size_t data_start = HEADER_SIZE + 4 * std::size_t(count);
+    if (std::memcmp(bloom_data, BLOOM_SIGNATURE, 4) != 0 || utils::read_u32(bloom_data + 4) != BLOOM_VERSION || utils::read_u32(bloom_data + 8) != count
+        || bloom_length < data_start || (count > 0 && bloom_length != data_start + utils::read_u32(bloom_data + data_start - 4))) {
+        unmap_file(bloom_data, bloom_length);
+    }
+}
+
+CommitGraphFile::~CommitGraphFile() {
+    unmap_file(data, length);
+    unmap_file(bloom_data, bloom_length);
+}
+
+const CommitGraphFile& CommitGraphFile::get_shared() {
+    static const CommitGraphFile graph_file;
+    return graph_file;
+}
+
+const unsigned char* CommitGraphFile::get_row(const uint32_t position) const {
+    return data + HEADER_SIZE + FANOUT_SIZE + std::size_t(position) * ROW_SIZE;
+}
+
+bool CommitGraphFile::find(const unsigned char* id, uint32_t& position) const {
+    if (count == 0) { return false; }
+
+    const unsigned char* fanout = data + HEADER_SIZE;
+    uint32_t low = (id[0] == 0) ? 0 : utils::read_u32(fanout + 4 * (id[0] - 1));
+    uint32_t high = utils::read_u32(fanout + 4 * id[0]);
+
+    while (low < high) {
+        const uint32_t mid = low + (high - low) / 2;
+        const int cmp = std::memcmp(get_row(mid), id, ID_SIZE);
+        if (cmp == 0) { position = mid; return true; }
+        if (cmp < 0) { low = mid + 1; }
+        else { high = mid; }
+    }
+    return false;
+}
+
+std::string CommitGraphFile::get_filter(const uint32_t position) const {
+    if (bloom_data == nullptr) { return ""; }
+
+    const unsigned char* ends = bloom_data + HEADER_SIZE;
+    const uint32_t start = (position == 0) ? 0 : utils::read_u32(ends + 4 * (position - 1));
+    const uint32_t end = utils::read_u32(ends + 4 * position);
+    return std::string(reinterpret_cast<const char*>(ends + 4 * std::size_t(count) + start), end - start);
+}
+
+bool CommitGraphFile::may_have_changed(const std::string& commit_hash, const std::string& path) const {
+    const std::string id = utils::hash_to_raw(commit_hash);
+    uint32_t position;
+    if (id.empty() || !find(reinterpret_cast<const unsigned char*>(id.data()), position)) { return true; }
+
+    return filter_contains(get_filter(position), path);
+}
+
+bool CommitGraphFile::lookup(const std::string& commit_hash, CommitNode& node) const {
+    const std::string id = utils::hash_to_raw(commit_hash);
+    uint32_t position;
+    if (id.empty() || !find(reinterpret_cast<const unsigned char*>(id.data()), position)) { return false; }
+
+    const unsigned char* row = get_row(position);
+    node.tree_hash = utils::raw_to_hash(row + ID_SIZE);
+    node.parents.clear();
+    for (const uint32_t parent : {utils::read_u32(row + 40), utils::read_u32(row + 44)}) {
+        if (parent != NO_PARENT) { node.parents.push_back(utils::raw_to_hash(get_row(parent))); }
+    }
+    node.time = std::time_t(utils::read_u64(row + 48));
+    node.generation = utils::read_u32(row + 56);
+    return true;
+}
+
+void CommitGraphFile::add_commit(const std::string& commit_hash) {
+    const CommitGraphFile graph_file;
+
+    // Commits without a row, the walk stops at commits the file already has. Keyed by raw id so they come out sorted.
+    std::map<std::string, CommitNode> new_nodes;
+    std::vector<std::string> stack = {commit_hash};
+
+    while (!stack.empty()) {
+        const std::string hash = stack.back();
+        stack.pop_back();
+
+        const std::string id = utils::hash_to_raw(hash);
+        uint32_t position;
+        if (new_nodes.count(id) || graph_file.find(reinterpret_cast<const unsigned char*>(id.data()), position)) { continue; }
+
+        CommitNode node = parse_commit(hash);
+        if (node.parents.size() > 2) {
+            const std::string error_msg = "Commit " + hash + " has more than two parents";
+            throw std::logic_error(error_msg);
+        }
+        for (const std::string& parent_hash : node.parents) { stack.push_back(parent_hash); }
+        new_nodes.emplace(id, node);
+    }
+
+    if (new_nodes.empty()) { return; }
+
+    auto get_generation = [&](const std::string& id) -> uint32_t {
+        auto it = new_nodes.find(id);
+        if (it != new_nodes.end()) { return it->second.generation; }
+        uint32_t position;
+        graph_file.find(reinterpret_cast<const unsigned char*>(id.data()), position);
+        return utils::read_u32(graph_file.get_row(position) + 56);
+    };
+
+    // Generations of the new commits, parents first
+    for (auto& [id, node] : new_nodes) {
+        std::vector<std::string> pending = {id};
+        while (!pending.empty()) {
+            CommitNode& current = new_nodes.at(pending.back());
+            if (current.generation != 0) { pending.pop_back(); continue; }
+
+            uint32_t generation = 1;
+            bool is_ready = true;
+            for (const std::string& parent_hash : current.parents) {
+                const std::string parent_id = utils::hash_to_raw(parent_hash);
+                const uint32_t parent_generation = get_generation(parent_id);
+                if (parent_generation == 0) { pending.push_back(parent_id); is_ready = false; }
+                else { generation = std::max(generation, parent_generation + 1); }
+            }
+
+            if (is_ready) { current.generation = generation; pending.pop_back(); }
+        }
+    }
+
+    // Merge the sorted old and new rows, remembering where every row ends up
+    const uint32_t old_count = graph_file.count;
+    const uint32_t total_count = old_count + new_nodes.size();
+    std::vector<uint32_t> old_positions(old_count);
+    std::map<std::string, uint32_t> new_positions;
+
+    uint32_t old_index = 0, position = 0;
+    auto it = new_nodes.begin();
+    while (old_index < old_count || it != new_nodes.end()) {
+        if (it == new_nodes.end() || (old_index < old_count && std::memcmp(graph_file.get_row(old_index), it->first.data(), ID_SIZE) < 0)) {
+            old_positions[old_index++] = position++;
+        } else {
+            new_positions[it->first] = position++;
+            ++it;
+        }
+    }
+
+    std::vector<unsigned char> buffer(HEADER_SIZE + FANOUT_SIZE + std::size_t(total_count) * ROW_SIZE, 0);
+    std::memcpy(buffer.data(), GRAPH_SIGNATURE, 4);
+    utils::write_u32(buffer.data() + 4, GRAPH_VERSION);
+    utils::write_u32(buffer.data() + 8, total_count);
+
+    auto row_at = [&](const uint32_t row_position) { return buffer.data() + HEADER_SIZE + FANOUT_SIZE + std::size_t(row_position) * ROW_SIZE; };
+
+    for (uint32_t i = 0; i < old_count; i++) {
+        unsigned char* row = row_at(old_positions[i]);
+        std::memcpy(row, graph_file.get_row(i), ROW_SIZE);
+        for (unsigned char* parent : {row + 40, row + 44}) {
+            if (utils::read_u32(parent) != NO_PARENT) { utils::write_u32(parent, old_positions[utils::read_u32(parent)]); }
+        }
+    }
+
+    for (const auto& [id, node] : new_nodes) {
+        unsigned char* row = row_at(new_positions.at(id));
+        std::memcpy(row, id.data(), ID_SIZE);
+        std::memcpy(row + ID_SIZE, utils::hash_to_raw(node.tree_hash).data(), ID_SIZE);
+
+        utils::write_u32(row + 40, NO_PARENT);
+        utils::write_u32(row + 44, NO_PARENT);
+        for (std::size_t i = 0; i < node.parents.size(); i++) {
+            const std::string parent_id = utils::hash_to_raw(node.parents[i]);
+            auto new_it = new_positions.find(parent_id);
+            uint32_t parent_position;
+            if (new_it != new_positions.end()) { parent_position = new_it->second; }
+            else {
+                graph_file.find(reinterpret_cast<const unsigned char*>(parent_id.data()), parent_position);
+                parent_position = old_positions[parent_position];
+            }
+            utils::write_u32(row + 40 + 4 * i, parent_position);
+        }
+
+        utils::write_u64(row + 48, uint64_t(node.time));
+        utils::write_u32(row + 56, node.generation);
+    }
+
+    uint32_t fanout[256] = {};
+    for (uint32_t i = 0; i < total_count; i++) { fanout[row_at(i)[0]]++; }
+    for (int i = 1; i < 256; i++) { fanout[i] += fanout[i - 1]; }
+    for (int i = 0; i < 256; i++) { utils::write_u32(buffer.data() + HEADER_SIZE + 4 * i, fanout[i]); }
+
+    // Filters of existing rows are copied, a graph written without them gets them all computed once
+    std::vector<std::string> filters(total_count);
+    for (uint32_t i = 0; i < old_count; i++) {
+        if (graph_file.bloom_data != nullptr) { filters[old_positions[i]] = graph_file.get_filter(i); continue; }
+
+        const unsigned char* row = graph_file.get_row(i);
+        const uint32_t parent = utils::read_u32(row + 40);
+        filters[old_positions[i]] = compute_filter(utils::raw_to_hash(row + ID_SIZE), (parent == NO_PARENT) ? "" : utils::raw_to_hash(graph_file.get_row(parent) + ID_SIZE));
+    }
+
+    for (const auto& [id, node] : new_nodes) {
+        std::string parent_tree_hash;
+        if (!node.parents.empty()) {
+            auto parent_it = new_nodes.find(utils::hash_to_raw(node.parents.front()));
+            if (parent_it != new_nodes.end()) { parent_tree_hash = parent_it->second.tree_hash; }
+            else {
+                CommitNode parent_node;
+                graph_file.lookup(node.parents.front(), parent_node);
+                parent_tree_hash = parent_node.tree_hash;
+            }
+        }
+        filters[new_positions.at(id)] = compute_filter(node.tree_hash, parent_tree_hash);
+    }
+
+    std::vector<unsigned char> bloom_buffer(HEADER_SIZE + 4 * std::size_t(total_count));
+    std::memcpy(bloom_buffer.data(), BLOOM_SIGNATURE, 4);
+    utils::write_u32(bloom_buffer.data() + 4, BLOOM_VERSION);
+    utils::write_u32(bloom_buffer.data() + 8, total_count);
+    utils::write_u32(bloom_buffer.data() + 12, 0);
+
+    uint32_t end = 0;
+    for (uint32_t i = 0; i < total_count; i++) {
+        end += filters[i].size();
+        utils::write_u32(bloom_buffer.data() + HEADER_SIZE + 4 * i, end);
+        bloom_buffer.insert(bloom_buffer.end(), filters[i].begin(), filters[i].end());
+    }
+
+    // Written aside and renamed over, readers holding the old mapping keep a consistent view. The filters go first,
+    // until the graph follows their row count doesn't match and they're ignored.
+    auto replace_file = [](const std::string& link_path, const std::vector<unsigned char>& content) {
+        const std::string path = utils::resolve_symlink(link_path);
+        const std::string lock_path = path + ".lock";
+        std::ofstream out(lock_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            const std::string error_msg = "Failed to open file: " + lock_path;
+            throw std::runtime_error(error_msg);
+        }
+        out.write(reinterpret_cast<const char*>(content.data()), content.size());
+        out.close();
+
+        fs::rename(lock_path, path);
+    };
+
+    replace_file(config::BLOOM_FILE, bloom_buffer);
+    replace_file(config::COMMIT_GRAPH_FILE, buffer);
+}
+
+CommitNode& CommitGraph::load_commit(const std::string& commit_hash) {
+    auto it = nodes.find(commit_hash);
+    if (it != nodes.end()) { return it->second; }
+
+    CommitNode node{"", {}, 0, 0};
+    if (!graph_file.lookup(commit_hash, node)) { node = parse_commit(commit_hash); }
+
+    return nodes.emplace(commit_hash, node).first->second;
+}
+
+const CommitNode& CommitGraph::get_commit(const std::string& commit_hash) {
+    return load_commit(commit_hash);
+}
+
+uint32_t CommitGraph::get_generation(const std::string& commit_hash) {
+    if (load_commit(commit_hash).generation != 0) { return nodes.at(commit_hash).generation; }
+
+    // Post-order walk without recursion, histories can be deeper than the stack
+    std::vector<std::string> stack = {commit_hash};
+
+    while (!stack.empty()) {
+        CommitNode& node = load_commit(stack.back());
+        if (node.generation != 0) { stack.pop_back(); continue; }
+
+        uint32_t generation = 1;
+        bool is_ready = true;
+
+        // References into 'nodes' stay valid while more commits are loaded
+        for (const std::string& parent_hash : node.parents) {
+            const uint32_t parent_generation = load_commit(parent_hash).generation;
+            if (parent_generation == 0) { stack.push_back(parent_hash); is_ready = false; }
+            else { generation = std::max(generation, parent_generation + 1); }
+        }
+
+        if (is_ready) {
+            nodes.at(stack.back()).generation = generation;
+            stack.pop_back();
+        }
+    }
+
+    return nodes.at(commit_hash).generation;
+}
+
+std::vector<std::string> CommitGraph::get_merge_bases(const std::string& commit_hash1, const std::string& commit_hash2) {
+    if (commit_hash1 == commit_hash2) { return {commit_hash1}; }
+
+    enum : uint8_t { PARENT1 = 1, PARENT2 = 2, STALE = 4, RESULT = 8 };
+
+    // Newest first: highest generation, then latest commit time. A commit is only popped after all its descendants
+    // in the walk, so its flags are final when it's expanded.
+    using QueueEntry = std::tuple<uint32_t, std::time_t, std::string>;
+    std::priority_queue<QueueEntry> queue;
+
+    std::unordered_map<std::string, uint8_t> flags;
+    std::unordered_map<std::string, int> queued;   // copies of a commit in the queue
+    size_t non_stale = 0;                          // queue entries whose commit isn't stale
+
+    auto push = [&](const std::string& commit_hash) {
+        queue.push({get_generation(commit_hash), load_commit(commit_hash).time, commit_hash});
+        ++queued[commit_hash];
+        if (!(flags[commit_hash] & STALE)) { ++non_stale; }
+    };
+
+    auto mark_stale = [&](const std::string& commit_hash) {
+        if (flags[commit_hash] & STALE) { return; }
+        flags[commit_hash] |= STALE;
+        non_stale -= queued[commit_hash];
+    };
+
+    flags[commit_hash1] = PARENT1;
+    flags[commit_hash2] = PARENT2;
+    push(commit_hash1);
+    push(commit_hash2);
+
+    std::vector<std::string> results;
+
+    // Stops as soon as everything left is below a common ancestor already found
+    while (non_stale > 0) {
+        const std::string commit_hash = std::get<2>(queue.top());
+        queue.pop();
+        --queued[commit_hash];
+
+        uint8_t commit_flags = flags[commit_hash] & (PARENT1 | PARENT2 | STALE);
+        if (!(commit_flags & STALE)) { --non_stale; }
+
+        if (commit_flags == (PARENT1 | PARENT2)) {
+            if (!(flags[commit_hash] & RESULT)) {
+                flags[commit_hash] |= RESULT;
+                results.push_back(commit_hash);
+            }
+            mark_stale(commit_hash);
+            commit_flags |= STALE;
+        }
+
+        for (const std::string& parent_hash : load_commit(commit_hash).parents) {
+            const uint8_t parent_flags = flags[parent_hash];
+            if ((parent_flags & commit_flags) == commit_flags) { continue; }
+
+            if ((commit_flags & STALE) && !(parent_flags & STALE)) {
+                mark_stale(parent_hash);
+            }
+            flags[parent_hash] |= commit_flags;
+            push(parent_hash);
+        }
+    }
+
+    // A result reachable from another result is only a common ancestor of a better one
+    std::vector<std::string> merge_bases;
+    for (const std::string& candidate : results) {
+        bool is_redundant = false;
+        for (const std::string& other : results) {
+            if (other != candidate && is_ancestor(candidate, other)) { is_redundant = true; break; }
+        }
+        if (!is_redundant) { merge_bases.push_back(candidate); }
+    }
+
+    std::sort(merge_bases.begin(), merge_bases.end(), [&](const std::string& a, const std::string& b) {
+        return std::make_tuple(get_generation(a), load_commit(a).time, a) > std::make_tuple(get_generation(b), load_commit(b).time, b);
+    });
+
+    return merge_bases;
+}
+
+std::string CommitGraph::get_merge_base(const std::string& commit_hash1, const std::string& commit_hash2) {
+    const std::vector<std::string> merge_bases = get_merge_bases(commit_hash1, commit_hash2);
+    return merge_bases.empty() ? "" : merge_bases.front();
+}
+
+bool CommitGraph::is_ancestor(const std::string& ancestor, const std::string& descendant) {
+    const uint32_t min_generation = get_generation(ancestor);
+
+    std::unordered_set<std::string> visited = {descendant};
+    std::vector<std::string> stack = {descendant};
+
+    while (!stack.empty()) {
+        const std::string commit_hash = stack.back();
+        stack.pop_back();
+
+        if (commit_hash == ancestor) { return true; }
+
+        // Everything below the ancestor's generation can't reach it
+        if (get_generation(commit_hash) <= min_generation) { continue; }
+
+        for (const std::string& parent_hash : load_commit(commit_hash).parents) {
+            if (visited.insert(parent_hash).second) { stack.push_back(parent_hash); }
+        }
+    }
+
+    return false;
+}
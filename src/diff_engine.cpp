@@ -0,0 +1,511 @@
+#include "diff_engine.hpp"
+#include "utils.hpp"
+#include <unordered_map>
+#include <cstdint>
+#include <cctype>
+#include <climits>
+#include <algorithm>
+#include <set>
+
+namespace diff_engine {
+
+    void intern_lines(const std::vector<std::string>& old_lines, const std::vector<std::string>& new_lines, std::vector<int>& old_ids, std::vector<int>& new_ids) {
+        std::unordered_map<std::string, int> ids;
+        ids.reserve(old_lines.size() + new_lines.size());
+
+        old_ids.clear();
+        old_ids.reserve(old_lines.size());
+        for (const std::string& line : old_lines) {
+            old_ids.push_back(ids.emplace(line, (int)ids.size()).first->second);
+        }
+
+        new_ids.clear();
+        new_ids.reserve(new_lines.size());
+        for (const std::string& line : new_lines) {
+            new_ids.push_back(ids.emplace(line, (int)ids.size()).first->second);
+        }
+    }
+
+    std::pair<int, int> count_line_changes(const std::vector<std::string>& old_lines, const std::vector<std::string>& new_lines) {
+        std::vector<int> a, b;
+        intern_lines(old_lines, new_lines, a, b);
+
+        // Common prefix and suffix never take part in the edit script
+        int begin = 0;
+        int end_a = a.size();
+        int end_b = b.size();
+        while (begin < end_a && begin < end_b && a[begin] == b[begin]) { ++begin; }
+        while (end_a > begin && end_b > begin && a[end_a - 1] == b[end_b - 1]) { --end_a; --end_b; }
+
+        const int n = end_a - begin;
+        const int m = end_b - begin;
+
+        if (n == 0 || m == 0) { return {n, m}; }
+
+        // Forward Myers pass, v[k] holds the furthest x reached on diagonal k
+        const int max_d = n + m;
+        const int offset = max_d + 1;
+        std::vector<int> v(2 * max_d + 3, 0);
+
+        for (int d = 0; d <= max_d; ++d) {
+            for (int k = -d; k <= d; k += 2) {
+                int x;
+                if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+                    x = v[offset + k + 1];      // step down: insertion
+                } else {
+                    x = v[offset + k - 1] + 1;  // step right: deletion
+                }
+
+                int y = x - k;
+                while (x < n && y < m && a[begin + x] == b[begin + y]) { ++x; ++y; }
+
+                v[offset + k] = x;
+
+                if (x >= n && y >= m) {
+                    // d = deleted + added and m - n = added - deleted
+                    return {(d + n - m) / 2, (d - n + m) / 2};
+                }
+            }
+        }
+
+        return {n, m};
+    }
+
+    // Middle snake of a[a_begin, a_end) against b[b_begin, b_end): a forward and a backward Myers pass run until
+    // they overlap, the snake where they meet splits the script in two halves with about half of the edits each.
+    // vf and vb hold the furthest x of every diagonal (vb counted from the ends), so memory is O(N+M) however many
+    // edits there are. Returns the edit distance, or -1 when it is more than 'max_edits'.
+    int find_middle_snake(const std::vector<int>& a, int a_begin, int a_end, const std::vector<int>& b, int b_begin, int b_end, int max_edits, std::vector<int>& vf, std::vector<int>& vb, int& snake_x, int& snake_y, int& snake_u, int& snake_v) {
+        const int n = a_end - a_begin;
+        const int m = b_end - b_begin;
+        const int delta = n - m;
+        const bool is_odd = delta & 1;
+        const int offset = vf.size() / 2;
+
+        vf[offset + 1] = 0;
+        vb[offset + 1] = 0;
+
+        const int max_d = std::min((n + m + 1) / 2, max_edits / 2 + 1);
+        for (int d = 0; d <= max_d; ++d) {
+            for (int k = -d; k <= d; k += 2) {
+                int x = (k == -d || (k != d && vf[offset + k - 1] < vf[offset + k + 1])) ? vf[offset + k + 1] : vf[offset + k - 1] + 1;
+                int y = x - k;
+                const int x0 = x, y0 = y;
+                while (x < n && y < m && a[a_begin + x] == b[b_begin + y]) { ++x; ++y; }
+                vf[offset + k] = x;
+
+                const int c = delta - k;
+                if (is_odd && c >= -(d - 1) && c <= d - 1 && vf[offset + k] + vb[offset + c] >= n) {
+                    snake_x = x0; snake_y = y0; snake_u = x; snake_v = y;
+                    return 2 * d - 1 > max_edits ? -1 : 2 * d - 1;
+                }
+            }
+
+            for (int c = -d; c <= d; c += 2) {
+                int x = (c == -d || (c != d && vb[offset + c - 1] < vb[offset + c + 1])) ? vb[offset + c + 1] : vb[offset + c - 1] + 1;
+                int y = x - c;
+                const int x0 = x, y0 = y;
+                while (x < n && y < m && a[a_end - 1 - x] == b[b_end - 1 - y]) { ++x; ++y; }
+                vb[offset + c] = x;
+
+                const int k = delta - c;
+                if (!is_odd && k >= -d && k <= d && vb[offset + c] + vf[offset + k] >= n) {
+                    snake_x = n - x; snake_y = m - y; snake_u = n - x0; snake_v = m - y0;
+                    return 2 * d > max_edits ? -1 : 2 * d;
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    // Appends the script of a[a_begin, a_end) against b[b_begin, b_end), split at middle snakes until one side is empty
+    void build_edit_script(const std::vector<int>& a, int a_begin, int a_end, const std::vector<int>& b, int b_begin, int b_end, std::vector<int>& vf, std::vector<int>& vb, std::vector<char>& script) {
+        while (a_begin < a_end && b_begin < b_end && a[a_begin] == b[b_begin]) { script.push_back('='); ++a_begin; ++b_begin; }
+
+        int suffix = 0;
+        while (a_end > a_begin && b_end > b_begin && a[a_end - 1] == b[b_end - 1]) { --a_end; --b_end; ++suffix; }
+
+        if (a_begin == a_end || b_begin == b_end) {
+            script.insert(script.end(), a_end - a_begin, '-');
+            script.insert(script.end(), b_end - b_begin, '+');
+        }
+        else {
+            int x, y, u, v;
+            find_middle_snake(a, a_begin, a_end, b, b_begin, b_end, INT_MAX, vf, vb, x, y, u, v);
+
+            build_edit_script(a, a_begin, a_begin + x, b, b_begin, b_begin + y, vf, vb, script);
+            script.insert(script.end(), u - x, '=');
+            build_edit_script(a, a_begin + u, a_end, b, b_begin + v, b_end, vf, vb, script);
+        }
+
+        script.insert(script.end(), suffix, '=');
+    }
+
+    std::vector<char> get_edit_script(const std::vector<std::string>& old_tokens, const std::vector<std::string>& new_tokens, int max_edits) {
+        std::vector<int> a, b;
+        intern_lines(old_tokens, new_tokens, a, b);
+
+        const int n = a.size();
+        const int m = b.size();
+        const int offset = n + m + 2;
+        std::vector<int> vf(2 * offset + 1), vb(2 * offset + 1);
+
+        // The distance is known once the first middle snake is found, before any script is built
+        int begin = 0, end_a = n, end_b = m;
+        while (begin < end_a && begin < end_b && a[begin] == b[begin]) { ++begin; }
+        while (end_a > begin && end_b > begin && a[end_a - 1] == b[end_b - 1]) { --end_a; --end_b; }
+
+        if (begin < end_a && begin < end_b) {
+            int x, y, u, v;
+            if (find_middle_snake(a, begin, end_a, b, begin, end_b, max_edits, vf, vb, x, y, u, v) < 0) { return {}; }
+        }
+        else if ((end_a - begin) + (end_b - begin) > max_edits) {
+            return {};
+        }
+
+        std::vector<char> script;
+        script.reserve(n + m);
+        build_edit_script(a, 0, n, b, 0, m, vf, vb, script);
+        return script;
+    }
+
+    // matches[i] is the line of 'other' that base line i is kept as, -1 when it was deleted or changed
+    std::vector<int> get_line_matches(const std::vector<std::string>& base_lines, const std::vector<std::string>& other_lines) {
+        std::vector<int> matches(base_lines.size(), -1);
+        int i = 0, j = 0;
+        for (char op : get_edit_script(base_lines, other_lines, INT_MAX)) {
+            if (op == '=') { matches[i++] = j++; }
+            else if (op == '-') { ++i; }
+            else { ++j; }
+        }
+        return matches;
+    }
+
+    bool merge_lines(const std::vector<std::string>& base_lines, const std::vector<std::string>& ours_lines, const std::vector<std::string>& theirs_lines, const std::string& ours_label, const std::string& theirs_label, std::vector<std::string>& merged_lines) {
+        const std::vector<int> ours_matches = get_line_matches(base_lines, ours_lines);
+        const std::vector<int> theirs_matches = get_line_matches(base_lines, theirs_lines);
+
+        const int base_size = base_lines.size();
+        bool is_clean = true;
+        int i = 0, j = 0, k = 0; // base, ours, theirs
+
+        while (true) {
+            // Stable region, the base line is kept at the current position on both sides
+            while (i < base_size && ours_matches[i] == j && theirs_matches[i] == k) {
+                merged_lines.push_back(base_lines[i]);
+                ++i; ++j; ++k;
+            }
+
+            // Unstable region, up to the next base line both sides kept
+            int next = i;
+            while (next < base_size && (ours_matches[next] < 0 || theirs_matches[next] < 0)) { ++next; }
+            const int ours_end = (next < base_size) ? ours_matches[next] : (int)ours_lines.size();
+            const int theirs_end = (next < base_size) ? theirs_matches[next] : (int)theirs_lines.size();
+
+            if (i == next && j == ours_end && k == theirs_end) { break; }
+
+            const std::vector<std::string> base_chunk(base_lines.begin() + i, base_lines.begin() + next);
+            const std::vector<std::string> ours_chunk(ours_lines.begin() + j, ours_lines.begin() + ours_end);
+            const std::vector<std::string> theirs_chunk(theirs_lines.begin() + k, theirs_lines.begin() + theirs_end);
+
+            if (ours_chunk == base_chunk || ours_chunk == theirs_chunk) {
+                merged_lines.insert(merged_lines.end(), theirs_chunk.begin(), theirs_chunk.end());
+            } else if (theirs_chunk == base_chunk) {
+                merged_lines.insert(merged_lines.end(), ours_chunk.begin(), ours_chunk.end());
+            } else {
+                is_clean = false;
+                merged_lines.push_back("<<<<<<< " + ours_label);
+                merged_lines.insert(merged_lines.end(), ours_chunk.begin(), ours_chunk.end());
+                merged_lines.push_back("=======");
+                merged_lines.insert(merged_lines.end(), theirs_chunk.begin(), theirs_chunk.end());
+                merged_lines.push_back(">>>>>>> " + theirs_label);
+            }
+
+            i = next; j = ours_end; k = theirs_end;
+        }
+
+        return is_clean;
+    }
+
+    std::vector<std::string> tokenize_words(const std::string& line) {
+        auto is_word = [](unsigned char c) { return std::isalnum(c) || c == '_'; };
+
+        std::vector<std::string> tokens;
+        size_t i = 0;
+        while (i < line.size()) {
+            size_t j = i + 1;
+            const unsigned char c = line[i];
+
+            if (is_word(c)) { while (j < line.size() && is_word(line[j])) { ++j; } }
+            else if (std::isspace(c)) { while (j < line.size() && std::isspace((unsigned char)line[j])) { ++j; } }
+
+            tokens.push_back(line.substr(i, j - i));
+            i = j;
+        }
+        return tokens;
+    }
+
+    std::vector<FileChange> diff_trees(const std::string& old_tree_hash, const std::string& new_tree_hash, const std::string& path) {
+        std::vector<FileChange> changes;
+        if (old_tree_hash == new_tree_hash) { return changes; }
+
+        std::map<std::string, TreeEntry> old_entries, new_entries;
+        if (!old_tree_hash.empty()) { for (const TreeEntry& entry : utils::read_tree(old_tree_hash)) { old_entries[entry.name] = entry; } }
+        if (!new_tree_hash.empty()) { for (const TreeEntry& entry : utils::read_tree(new_tree_hash)) { new_entries[entry.name] = entry; } }
+
+        std::set<std::string> names;
+        for (const auto& [name, entry] : old_entries) { names.insert(name); }
+        for (const auto& [name, entry] : new_entries) { names.insert(name); }
+
+        for (const std::string& name : names) {
+            auto old_it = old_entries.find(name);
+            auto new_it = new_entries.find(name);
+            const TreeEntry* old_entry = (old_it == old_entries.end()) ? nullptr : &old_it->second;
+            const TreeEntry* new_entry = (new_it == new_entries.end()) ? nullptr : &new_it->second;
+
+            const std::string filepath = path + name;
+            const bool is_old_tree = old_entry != nullptr && old_entry->type == "tree";
+            const bool is_new_tree = new_entry != nullptr && new_entry->type == "tree";
+
+            if (is_old_tree || is_new_tree) {
+                const std::vector<FileChange> sub_changes = diff_trees(is_old_tree ? old_entry->hash : "", is_new_tree ? new_entry->hash : "", filepath + "/");
+                changes.insert(changes.end(), sub_changes.begin(), sub_changes.end());
+            }
+
+            // A file replaced by a directory (or the other way around) is a deletion plus additions
+            const bool is_old_blob = old_entry != nullptr && !is_old_tree;
+            const bool is_new_blob = new_entry != nullptr && !is_new_tree;
+
+            if (is_old_blob && is_new_blob) {
+                if (old_entry->mode != new_entry->mode || old_entry->hash != new_entry->hash) {
+                    changes.push_back({filepath, {old_entry->mode, old_entry->hash}, {new_entry->mode, new_entry->hash}});
+                }
+            }
+            else if (is_old_blob) { changes.push_back({filepath, {old_entry->mode, old_entry->hash}, {}}); }
+            else if (is_new_blob) { changes.push_back({filepath, {}, {new_entry->mode, new_entry->hash}}); }
+        }
+
+        std::sort(changes.begin(), changes.end(), [](const FileChange& a, const FileChange& b) { return a.filepath < b.filepath; });
+        return changes;
+    }
+
+    const int MINHASH_SIZE = 64;    // signature slots per file
+    const int BAND_ROWS = 2;        // slots per locality-sensitive-hashing band
+    const size_t MAX_CHUNK_SIZE = 64;
+
+    uint64_t mix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    uint64_t fnv1a(const char* data, size_t size) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= (unsigned char)data[i];
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // Content is cut into chunks at line ends (at most MAX_CHUNK_SIZE bytes), every distinct chunk is one feature
+    std::vector<uint64_t> get_chunk_fingerprints(const std::string& content) {
+        std::vector<uint64_t> fingerprints;
+        size_t start = 0;
+
+        for (size_t i = 0; i < content.size(); ++i) {
+            if (content[i] == '\n' || i + 1 - start == MAX_CHUNK_SIZE) {
+                fingerprints.push_back(fnv1a(content.data() + start, i + 1 - start));
+                start = i + 1;
+            }
+        }
+        if (start < content.size()) {
+            fingerprints.push_back(fnv1a(content.data() + start, content.size() - start));
+        }
+
+        std::sort(fingerprints.begin(), fingerprints.end());
+        fingerprints.erase(std::unique(fingerprints.begin(), fingerprints.end()), fingerprints.end());
+        return fingerprints;
+    }
+
+    struct RenameCandidate {
+        std::string path;
+        std::string hash;
+        bool is_kept;                   // copy source, the file still exists on the new side
+        size_t chunk_count;
+        std::vector<uint64_t> signature;
+    };
+
+    RenameCandidate make_rename_candidate(const std::string& path, const std::string& hash, bool is_kept) {
+        const std::vector<uint64_t> fingerprints = get_chunk_fingerprints(utils::get_blob_content(hash));
+
+        RenameCandidate candidate{path, hash, is_kept, fingerprints.size(), std::vector<uint64_t>(MINHASH_SIZE, UINT64_MAX)};
+        for (uint64_t fingerprint : fingerprints) {
+            for (int i = 0; i < MINHASH_SIZE; ++i) {
+                candidate.signature[i] = std::min(candidate.signature[i], mix64(fingerprint ^ mix64(i)));
+            }
+        }
+        return candidate;
+    }
+
+    int estimate_similarity(const RenameCandidate& a, const RenameCandidate& b) {
+        if (a.chunk_count == 0 || b.chunk_count == 0) { return 0; }
+
+        // Jaccard similarity can't be higher than the ratio of the set sizes
+        const size_t min_count = std::min(a.chunk_count, b.chunk_count);
+        const size_t max_count = std::max(a.chunk_count, b.chunk_count);
+        if (min_count * 100 < (size_t)config::RENAME_SIMILARITY * max_count) { return 0; }
+
+        int equal = 0;
+        for (int i = 0; i < MINHASH_SIZE; ++i) {
+            if (a.signature[i] == b.signature[i]) { ++equal; }
+        }
+        return equal * 100 / MINHASH_SIZE;
+    }
+
+    std::string get_base_name(const std::string& path) {
+        const size_t pos = path.find_last_of('/');
+        return (pos == std::string::npos) ? path : path.substr(pos + 1);
+    }
+
+    void split_changes(const FileMap& old_files, const FileMap& new_files, FileMap& deleted_files, FileMap& added_files, FileMap& modified_files) {
+        for (const auto& [path, old_file] : old_files) {
+            auto it = new_files.find(path);
+            if (it == new_files.end()) { deleted_files[path] = old_file; }
+            else if (it->second.second != old_file.second) { modified_files[path] = old_file; }
+        }
+
+        for (const auto& [path, new_file] : new_files) {
+            if (old_files.find(path) == old_files.end()) { added_files[path] = new_file; }
+        }
+    }
+
+    std::vector<RenameMatch> detect_renames(const FileMap& deleted_files, const FileMap& added_files, const FileMap& copy_sources, const bool is_exact_only) {
+        std::vector<RenameMatch> matches;
+        std::map<std::string, bool> is_source_used; // deleted file already taken by a rename
+        std::map<std::string, bool> is_added_matched;
+
+        // Exact renames and copies by blob hash
+        std::unordered_map<std::string, std::vector<std::string>> deleted_by_hash, kept_by_hash;
+        for (const auto& [path, file] : deleted_files) { deleted_by_hash[file.second].push_back(path); }
+        for (const auto& [path, file] : copy_sources) { kept_by_hash[file.second].push_back(path); }
+
+        for (const auto& [path, file] : added_files) {
+            auto it = deleted_by_hash.find(file.second);
+            if (it != deleted_by_hash.end()) {
+                const std::vector<std::string>& sources = it->second;
+                auto unused = std::find_if(sources.begin(), sources.end(), [&](const std::string& source) { return !is_source_used[source]; });
+
+                if (unused != sources.end()) {
+                    matches.push_back({*unused, path, 100, false});
+                    is_source_used[*unused] = true;
+                } else {
+                    matches.push_back({sources.front(), path, 100, true});
+                }
+                is_added_matched[path] = true;
+                continue;
+            }
+
+            auto kept = kept_by_hash.find(file.second);
+            if (kept != kept_by_hash.end()) {
+                matches.push_back({kept->second.front(), path, 100, true});
+                is_added_matched[path] = true;
+            }
+        }
+
+        // Inexact renames on what is left, blobs are only read when both sides have candidates
+        const bool has_targets = std::any_of(added_files.begin(), added_files.end(), [&](const auto& p) { return !is_added_matched[p.first]; });
+        const bool has_sources = !copy_sources.empty() || std::any_of(deleted_files.begin(), deleted_files.end(), [&](const auto& p) { return !is_source_used[p.first]; });
+
+        if (is_exact_only || !has_targets || !has_sources) {
+            std::sort(matches.begin(), matches.end(), [](const RenameMatch& a, const RenameMatch& b) { return a.new_path < b.new_path; });
+            return matches;
+        }
+
+        std::vector<RenameCandidate> sources, targets;
+        for (const auto& [path, file] : deleted_files) {
+            if (!is_source_used[path]) { sources.push_back(make_rename_candidate(path, file.second, false)); }
+        }
+        for (const auto& [path, file] : copy_sources) {
+            sources.push_back(make_rename_candidate(path, file.second, true));
+        }
+        for (const auto& [path, file] : added_files) {
+            if (!is_added_matched[path]) { targets.push_back(make_rename_candidate(path, file.second, false)); }
+        }
+
+        // {similarity, {source_index, target_index}}
+        std::vector<std::pair<int, std::pair<size_t, size_t>>> scored_pairs;
+        size_t compared_pairs = 0;
+
+        auto score_pair = [&](size_t source_index, size_t target_index) {
+            ++compared_pairs;
+            const int similarity = estimate_similarity(sources[source_index], targets[target_index]);
+            if (similarity >= config::RENAME_SIMILARITY) {
+                scored_pairs.push_back({similarity, {source_index, target_index}});
+            }
+        };
+
+        if (sources.size() * targets.size() <= config::RENAME_PAIR_LIMIT) {
+            for (size_t t = 0; t < targets.size(); ++t) {
+                for (size_t s = 0; s < sources.size(); ++s) { score_pair(s, t); }
+            }
+        } else {
+            // Mass moves: only compare files that share a whole band of their signatures, up to the pair limit
+            std::unordered_map<uint64_t, std::vector<size_t>> buckets;
+            for (size_t s = 0; s < sources.size(); ++s) {
+                if (sources[s].chunk_count == 0) { continue; }
+                for (int band = 0; band < MINHASH_SIZE; band += BAND_ROWS) {
+                    uint64_t key = mix64(band);
+                    for (int row = band; row < band + BAND_ROWS; ++row) { key = mix64(key ^ sources[s].signature[row]); }
+                    buckets[key].push_back(s);
+                }
+            }
+
+            std::vector<size_t> last_seen(sources.size(), SIZE_MAX);
+            for (size_t t = 0; t < targets.size() && compared_pairs < config::RENAME_PAIR_LIMIT; ++t) {
+                if (targets[t].chunk_count == 0) { continue; }
+                for (int band = 0; band < MINHASH_SIZE && compared_pairs < config::RENAME_PAIR_LIMIT; band += BAND_ROWS) {
+                    uint64_t key = mix64(band);
+                    for (int row = band; row < band + BAND_ROWS; ++row) { key = mix64(key ^ targets[t].signature[row]); }
+
+                    auto bucket = buckets.find(key);
+                    if (bucket == buckets.end()) { continue; }
+
+                    // A bucket can hold most of the sources (e.g. many near-identical files), the limit holds per pair
+                    for (size_t s : bucket->second) {
+                        if (compared_pairs >= config::RENAME_PAIR_LIMIT) { break; }
+                        if (last_seen[s] == t) { continue; }
+                        last_seen[s] = t;
+                        score_pair(s, t);
+                    }
+                }
+            }
+        }
+
+        // Best pairs first, same file name wins ties
+        std::sort(scored_pairs.begin(), scored_pairs.end(), [&](const auto& a, const auto& b) {
+            if (a.first != b.first) { return a.first > b.first; }
+            const bool a_same_name = get_base_name(sources[a.second.first].path) == get_base_name(targets[a.second.second].path);
+            const bool b_same_name = get_base_name(sources[b.second.first].path) == get_base_name(targets[b.second.second].path);
+            if (a_same_name != b_same_name) { return a_same_name; }
+            return a.second < b.second;
+        });
+
+        for (const auto& [similarity, pair] : scored_pairs) {
+            const RenameCandidate& source = sources[pair.first];
+            const RenameCandidate& target = targets[pair.second];
+
+            if (is_added_matched[target.path]) { continue; }
+
+            const bool is_copy = source.is_kept || is_source_used[source.path];
+            matches.push_back({source.path, target.path, similarity, is_copy});
+            if (!is_copy) { is_source_used[source.path] = true; }
+            is_added_matched[target.path] = true;
+        }
+
+        std::sort(matches.begin(), matches.end(), [](const RenameMatch& a, const RenameMatch& b) { return a.new_path < b.new_path; });
+        return matches;
+    }
+}
@@ -0,0 +1,84 @@
+#include "object_stream.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    const std::size_t CHUNK_SIZE = 64 * 1024;
+}
+
+ObjectStream::ObjectStream(const std::string& obj_path) : file(obj_path, std::ios::binary), in_buffer(CHUNK_SIZE), pending(CHUNK_SIZE) {
+    if (!file) {
+        const std::string error_msg = "Failed to open object file: " + obj_path;
+        throw std::runtime_error(error_msg);
+    }
+
+    if (inflateInit(&zs) != Z_OK) {
+        throw std::runtime_error("inflateInit failed while decompressing.");
+    }
+
+    try {
+        // The header is tiny, it's in the first output unless the object is corrupted
+        char* nul = nullptr;
+        while (nul == nullptr) {
+            if (is_end || pending_end == pending.size()) {
+                const std::string error_msg = "Corrupted object: missing null separator in " + obj_path;
+                throw std::runtime_error(error_msg);
+            }
+
+            pending_end += inflate_some(pending.data() + pending_end, pending.size() - pending_end);
+            nul = static_cast<char*>(std::memchr(pending.data(), '\0', pending_end));
+        }
+
+        const std::string header(pending.data(), nul);
+        const size_t space_pos = header.find(' ');
+        if (space_pos == std::string::npos || space_pos + 1 == header.size() || header.find_first_not_of("0123456789", space_pos + 1) != std::string::npos) {
+            const std::string error_msg = "Corrupted object: invalid header in " + obj_path;
+            throw std::runtime_error(error_msg);
+        }
+
+        obj_type = header.substr(0, space_pos);
+        obj_size = std::stoull(header.substr(space_pos + 1));
+        pending_begin = nul - pending.data() + 1;
+    } catch (...) {
+        // The destructor doesn't run for a constructor that throws
+        inflateEnd(&zs);
+        throw;
+    }
+}
+
+ObjectStream::~ObjectStream() {
+    inflateEnd(&zs);
+}
+
+std::size_t ObjectStream::inflate_some(char* out, std::size_t capacity) {
+    zs.next_out = reinterpret_cast<Bytef*>(out);
+    zs.avail_out = capacity;
+
+    while (zs.avail_out == capacity && !is_end) {
+        if (zs.avail_in == 0) {
+            file.read(in_buffer.data(), in_buffer.size());
+            if (file.gcount() == 0) { throw std::runtime_error("Corrupted object: compressed data ends early."); }
+
+            zs.next_in = reinterpret_cast<Bytef*>(in_buffer.data());
+            zs.avail_in = file.gcount();
+        }
+
+        const int ret = inflate(&zs, 0);
+        if (ret == Z_STREAM_END) { is_end = true; }
+        else if (ret != Z_OK) { throw std::runtime_error("inflate failed while decompressing."); }
+    }
+
+    return capacity - zs.avail_out;
+}
+
+std::size_t ObjectStream::read(char* out, std::size_t capacity) {
+    if (pending_begin < pending_end) {
+        const std::size_t count = std::min(capacity, pending_end - pending_begin);
+        std::memcpy(out, pending.data() + pending_begin, count);
+        pending_begin += count;
+        return count;
+    }
+
+    return is_end ? 0 : inflate_some(out, capacity);
+}
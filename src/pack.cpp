@@ -0,0 +1,234 @@
+#include "pack.hpp"
+#include "commit_graph.hpp"
+#include "object_stream.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include <openssl/evp.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstring>
+#include <memory>
+#include <queue>
+
+namespace {
+    const char PACK_SIGNATURE[4]       = {'V', 'C', 'S', 'P'};
+    const uint32_t PACK_VERSION        = 1;
+    const std::size_t HEADER_SIZE      = 12;
+    const std::size_t ENTRY_SIZE       = 28;
+    const std::size_t ID_SIZE          = 20;
+    const std::size_t CHUNK_SIZE       = 64 * 1024;
+
+    // True when the stored object at 'obj_path' inflates to content whose id is 'object_hash'
+    bool is_valid_object(const std::string& obj_path, const std::string& object_hash) {
+        ObjectStream stream(obj_path);
+
+        std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+        if (!ctx || EVP_DigestInit_ex(ctx.get(), EVP_sha1(), nullptr) != 1) { throw std::runtime_error("Failed to initialize SHA-1"); }
+
+        std::vector<char> buffer(CHUNK_SIZE);
+        std::size_t total = 0;
+        for (std::size_t n; (n = stream.read(buffer.data(), buffer.size())) > 0; total += n) {
+            EVP_DigestUpdate(ctx.get(), buffer.data(), n);
+        }
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digest_size = 0;
+        EVP_DigestFinal_ex(ctx.get(), digest, &digest_size);
+
+        return total == stream.size() && digest_size == ID_SIZE && utils::raw_to_hash(digest) == object_hash;
+    }
+}
+
+PackWriter::PackWriter(std::ostream& out, const uint32_t object_count) : out(out), buffer(CHUNK_SIZE) {
+    unsigned char header[HEADER_SIZE];
+    std::memcpy(header, PACK_SIGNATURE, 4);
+    utils::write_u32(header + 4, PACK_VERSION);
+    utils::write_u32(header + 8, object_count);
+    out.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+}
+
+void PackWriter::add(const std::string& object_hash, const std::string& object_path) {
+    std::ifstream file(object_path, std::ios::binary);
+    if (!file) {
+        const std::string error_msg = "Failed to open object file: " + object_path;
+        throw std::runtime_error(error_msg);
+    }
+
+    const uint64_t size = fs::file_size(object_path);
+    unsigned char entry[ENTRY_SIZE];
+    std::memcpy(entry, utils::hash_to_raw(object_hash).data(), ID_SIZE);
+    utils::write_u64(entry + ID_SIZE, size);
+    out.write(reinterpret_cast<const char*>(entry), ENTRY_SIZE);
+
+    for (uint64_t left = size; left > 0; ) {
+        file.read(buffer.data(), std::min<uint64_t>(left, buffer.size()));
+        if (file.gcount() <= 0) {
+            const std::string error_msg = "Object file changed while it was packed: " + object_path;
+            throw std::runtime_error(error_msg);
+        }
+        out.write(buffer.data(), file.gcount());
+        left -= file.gcount();
+    }
+
+    if (!out) { throw std::runtime_error("Failed to write pack"); }
+}
+
+PackReader::PackReader(std::istream& in) : in(in), buffer(CHUNK_SIZE) {
+    unsigned char header[HEADER_SIZE];
+    in.read(reinterpret_cast<char*>(header), HEADER_SIZE);
+
+    if (in.gcount() != std::streamsize(HEADER_SIZE) || std::memcmp(header, PACK_SIGNATURE, 4) != 0 || utils::read_u32(header + 4) != PACK_VERSION) {
+        throw std::runtime_error("Not a pack or unknown pack version");
+    }
+    remaining_count = utils::read_u32(header + 8);
+}
+
+void PackReader::skip(uint64_t size) {
+    for (; size > 0; size -= in.gcount()) {
+        in.read(buffer.data(), std::min<uint64_t>(size, buffer.size()));
+        if (in.gcount() <= 0) { throw std::runtime_error("Truncated pack"); }
+    }
+}
+
+bool PackReader::read_next() {
+    if (remaining_count == 0) { return false; }
+    --remaining_count;
+
+    unsigned char entry[ENTRY_SIZE];
+    in.read(reinterpret_cast<char*>(entry), ENTRY_SIZE);
+    if (in.gcount() != std::streamsize(ENTRY_SIZE)) { throw std::runtime_error("Truncated pack"); }
+
+    const std::string object_hash = utils::raw_to_hash(entry);
+    const uint64_t size = utils::read_u64(entry + ID_SIZE);
+
+    // Only this repository's own objects count, the object is stored even when an alternate has it
+    const std::string object_dir = config::OBJECTS_DIR + object_hash.substr(0, 2) + "/";
+    const std::string object_path = object_dir + object_hash.substr(2);
+    if (utils::is_file_exist(object_path)) {
+        skip(size);
+        return true;
+    }
+
+    if (utils::create_directory(object_dir) == utils::DIR_STATUS::ERROR) {
+        const std::string error_msg = "Failed to create directory: " + object_dir;
+        throw std::runtime_error(error_msg);
+    }
+
+    const std::string tmp_path = object_path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        const std::string error_msg = "Failed to open file: " + tmp_path;
+        throw std::runtime_error(error_msg);
+    }
+
+    for (uint64_t left = size; left > 0; left -= in.gcount()) {
+        in.read(buffer.data(), std::min<uint64_t>(left, buffer.size()));
+        if (in.gcount() <= 0) {
+            out.close();
+            fs::remove(tmp_path);
+            throw std::runtime_error("Truncated pack");
+        }
+        out.write(buffer.data(), in.gcount());
+    }
+    out.close();
+
+    bool is_valid = false;
+    try { is_valid = is_valid_object(tmp_path, object_hash); }
+    catch (const std::runtime_error&) {}
+
+    if (!is_valid) {
+        fs::remove(tmp_path);
+        const std::string error_msg = "Corrupted object in pack: " + object_hash;
+        throw std::runtime_error(error_msg);
+    }
+
+    fs::rename(tmp_path, object_path);
+    ++stored_count;
+    return true;
+}
+
+std::vector<std::string> get_pack_objects(const std::vector<std::string>& want_hashes, const std::vector<std::string>& have_hashes) {
+    CommitGraph graph;
+
+    // Highest generation first: every child is popped before its parents, so a commit reachable from a have is known
+    // to be common by the time it's popped. The walk ends once only common commits are queued.
+    std::priority_queue<std::pair<uint32_t, std::string>> queue;
+    std::unordered_map<std::string, bool> is_common;   // every commit queued so far
+    int new_count = 0;                                 // queued commits not known to be common
+
+    auto push = [&](const std::string& commit_hash, const bool common) {
+        auto [it, is_new] = is_common.try_emplace(commit_hash, common);
+        if (is_new) {
+            queue.emplace(graph.get_generation(commit_hash), commit_hash);
+            if (!common) { ++new_count; }
+        }
+        else if (common && !it->second) {
+            it->second = true;
+            --new_count;
+        }
+    };
+
+    for (const std::string& have_hash : have_hashes) {
+        if (utils::is_valid_hash_syntax(have_hash) && utils::is_exist_obj(have_hash)) { push(have_hash, true); }
+    }
+    for (const std::string& want_hash : want_hashes) { push(want_hash, false); }
+
+    std::vector<std::string> new_commits;
+    while (new_count > 0) {
+        const std::string commit_hash = queue.top().second;
+        queue.pop();
+
+        const bool common = is_common[commit_hash];
+        if (!common) {
+            --new_count;
+            new_commits.push_back(commit_hash);
+        }
+        for (const std::string& parent_hash : graph.get_commit(commit_hash).parents) { push(parent_hash, common); }
+    }
+
+    // Parents of new commits that aren't new themselves are common by now, the other side has everything under
+    // their trees
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> object_hashes = new_commits;
+
+    auto walk_tree = [&](const std::string& tree_hash, const bool is_wanted) {
+        std::vector<std::string> trees = {tree_hash};
+        while (!trees.empty()) {
+            const std::string cur_tree_hash = trees.back();
+            trees.pop_back();
+            if (!seen.insert(cur_tree_hash).second) { continue; }
+            if (is_wanted) { object_hashes.push_back(cur_tree_hash); }
+
+            for (const TreeEntry& entry : utils::read_tree(cur_tree_hash)) {
+                if (entry.type == "tree") { trees.push_back(entry.hash); }
+                else if (seen.insert(entry.hash).second && is_wanted) { object_hashes.push_back(entry.hash); }
+            }
+        }
+    };
+
+    for (const std::string& commit_hash : new_commits) {
+        for (const std::string& parent_hash : graph.get_commit(commit_hash).parents) {
+            if (is_common[parent_hash]) { walk_tree(graph.get_commit(parent_hash).tree_hash, false); }
+        }
+    }
+    for (const std::string& commit_hash : new_commits) { walk_tree(graph.get_commit(commit_hash).tree_hash, true); }
+
+    return object_hashes;
+}
+
+std::size_t transfer_objects(const std::vector<std::pair<std::string, std::string>>& objects) {
+    // Both repositories are local: the pack goes through an in-memory pipe that never holds more than one object
+    std::stringstream pipe;
+    PackWriter writer(pipe, objects.size());
+    PackReader reader(pipe);
+
+    for (const auto& [object_hash, object_path] : objects) {
+        pipe.str("");
+        pipe.clear();
+
+        writer.add(object_hash, object_path);
+        reader.read_next();
+    }
+
+    return reader.get_stored_count();
+}
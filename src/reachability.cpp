@@ -0,0 +1,349 @@
+#include "reachability.hpp"
+#include "commit_graph.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+#include "sparse_checkout.hpp"
+#include <cstring>
+
+namespace {
+    // Layout of .vcs/bitmaps, integers are big-endian:
+    //   header   "VCSR", version, object count, bitmap count          4 x 4 bytes
+    //   objects  object ids, sorted                                    object count x 20 bytes
+    //   bitmaps  commit's object index, compressed word count, words   4 + 4 + word count x 8 bytes each
+    const char BITMAP_SIGNATURE[4] = {'V', 'C', 'S', 'R'};
+    const uint32_t BITMAP_VERSION  = 1;
+    const std::size_t HEADER_SIZE  = 16;
+    const std::size_t ID_SIZE      = 20;
+
+    const uint64_t MAX_RUN_LENGTH    = 0xFFFFFFFFull;
+    const uint64_t MAX_LITERAL_COUNT = 0x7FFFFFFFull;
+}
+
+namespace ewah {
+    std::vector<uint64_t> compress(const std::vector<uint64_t>& words) {
+        std::vector<uint64_t> compressed;
+        std::size_t i = 0;
+
+        while (i < words.size()) {
+            uint64_t run_bit = 0, run_length = 0;
+            if (words[i] == 0 || words[i] == ~0ull) {
+                run_bit = (words[i] != 0);
+                while (i < words.size() && words[i] == (run_bit ? ~0ull : 0) && run_length < MAX_RUN_LENGTH) { ++run_length; ++i; }
+            }
+
+            const std::size_t literal_start = i;
+            while (i < words.size() && words[i] != 0 && words[i] != ~0ull && i - literal_start < MAX_LITERAL_COUNT) { ++i; }
+            const uint64_t literal_count = i - literal_start;
+
+            compressed.push_back(run_bit | (run_length << 1) | (literal_count << 33));
+            compressed.insert(compressed.end(), words.begin() + literal_start, words.begin() + i);
+        }
+
+        return compressed;
+    }
+
+    std::vector<uint64_t> decompress(const std::vector<uint64_t>& compressed, const std::size_t word_count) {
+        std::vector<uint64_t> words;
+        words.reserve(word_count);
+
+        std::size_t i = 0;
+        while (i < compressed.size()) {
+            const uint64_t marker = compressed[i++];
+            const uint64_t run_length = (marker >> 1) & MAX_RUN_LENGTH;
+            const uint64_t literal_count = marker >> 33;
+
+            if (words.size() + run_length + literal_count > word_count || i + literal_count > compressed.size()) {
+                throw std::runtime_error("Corrupted bitmap: more words than the object table holds");
+            }
+
+            words.insert(words.end(), run_length, (marker & 1) ? ~0ull : 0);
+            words.insert(words.end(), compressed.begin() + i, compressed.begin() + i + literal_count);
+            i += literal_count;
+        }
+
+        if (words.size() != word_count) { throw std::runtime_error("Corrupted bitmap: fewer words than the object table holds"); }
+        return words;
+    }
+}
+
+void collect_roots(std::vector<std::string>& commit_hashes, std::vector<std::string>& object_hashes) {
+    const std::string zero_hash = std::string(40, '0');
+
+    auto add = [&](std::vector<std::string>& hashes, const std::string& hash) {
+        if (hash != zero_hash && utils::is_valid_hash_syntax(hash)) { hashes.push_back(hash); }
+    };
+
+    // A blob staged in an index, or for a directory of the sparse index everything under its tree
+    auto add_index_entry = [&](const IndexEntry& entry) {
+        if (!SparseCheckout::is_sparse_dir(entry)) {
+            add(object_hashes, entry.hash);
+            return;
+        }
+
+        std::vector<std::string> trees = {entry.hash};
+        while (!trees.empty()) {
+            const std::string tree_hash = trees.back();
+            trees.pop_back();
+            add(object_hashes, tree_hash);
+
+            for (const TreeEntry& tree_entry : utils::read_tree(tree_hash)) {
+                if (tree_entry.type == "tree") { trees.push_back(tree_entry.hash); }
+                else { add(object_hashes, tree_entry.hash); }
+            }
+        }
+    };
+
+    for (const std::string& branch : utils::get_all_branches(config::REFS_HEAD_DIR)) {
+        add(commit_hashes, utils::read_file_content(config::REFS_HEAD_DIR + branch));
+    }
+
+    // Branches brought in by 'vcs fetch', one directory per source
+    if (utils::is_directory_exist(config::REFS_REMOTES_DIR)) {
+        for (const auto& entry : fs::recursive_directory_iterator(config::REFS_REMOTES_DIR)) {
+            if (entry.is_regular_file()) { add(commit_hashes, utils::read_file_content(entry.path().string())); }
+        }
+    }
+
+    // Commits a reset moved away from stay reachable through the reflog: <old-hash> <new-hash> ...
+    for (const std::string& branch : utils::get_all_branches(config::LOG_REFS_HEAD_DIR)) {
+        std::ifstream log_file(config::LOG_REFS_HEAD_DIR + branch);
+        std::string old_hash, new_hash, rest;
+        while (log_file >> old_hash >> new_hash && std::getline(log_file, rest)) {
+            add(commit_hashes, old_hash);
+            add(commit_hashes, new_hash);
+        }
+    }
+
+    // <parent-hash> <commit-hash> <index-hash> ...
+    if (utils::is_file_exist(config::STASH)) { add(commit_hashes, utils::read_file_content(config::STASH)); }
+    if (utils::is_file_exist(config::LOG_STASH)) {
+        std::ifstream log_file(config::LOG_STASH);
+        std::string parent_hash, commit_hash, index_hash, rest;
+        while (log_file >> parent_hash >> commit_hash >> index_hash && std::getline(log_file, rest)) {
+            add(commit_hashes, parent_hash);
+            add(commit_hashes, commit_hash);
+            add(object_hashes, index_hash);
+
+            // The saved index is a blob holding index lines, what it staged is only reachable through them
+            if (!utils::is_valid_hash_syntax(index_hash) || !utils::is_exist_obj(index_hash)) { continue; }
+
+            const std::string index_content = utils::read_and_decompress(utils::get_object_path(index_hash));
+            std::istringstream index_stream(index_content.substr(index_content.find('\0') + 1));
+            std::string line;
+            while (std::getline(index_stream, line)) {
+                std::istringstream line_stream(line);
+                IndexEntry entry;
+                if (line_stream >> entry.filepath >> entry.hash >> entry.size >> entry.mode >> entry.mtime) { add_index_entry(entry); }
+            }
+        }
+    }
+
+    // Every worktree has its own HEAD, MERGE_HEAD and index: "" in front of the paths for the current one, "<path>/"
+    // for the others
+    std::vector<std::string> worktree_prefixes = {""};
+    const std::string cur_worktree_path = fs::canonical(fs::current_path()).string();
+    for (const std::string& worktree_path : utils::get_worktree_paths()) {
+        if (worktree_path != cur_worktree_path) { worktree_prefixes.push_back(worktree_path + "/"); }
+    }
+
+    for (const std::string& prefix : worktree_prefixes) {
+        const std::string head_content = utils::read_file_content(prefix + config::HEAD_FILE);
+        if (head_content.find("ref: ") == std::string::npos) { add(commit_hashes, head_content); }
+        if (utils::is_file_exist(prefix + config::MERGE_HEAD_FILE)) { add(commit_hashes, utils::read_file_content(prefix + config::MERGE_HEAD_FILE)); }
+
+        // Staged but not committed yet
+        std::map<std::string, IndexEntry> index_entries;
+        if (utils::is_file_exist(prefix + config::INDEX_FILE)) { utils::read_index(index_entries, prefix + config::INDEX_FILE); }
+
+        for (const auto& [filepath, entry] : index_entries) { add_index_entry(entry); }
+    }
+
+    for (std::vector<std::string>* hashes : {&commit_hashes, &object_hashes}) {
+        std::sort(hashes->begin(), hashes->end());
+        hashes->erase(std::unique(hashes->begin(), hashes->end()), hashes->end());
+    }
+}
+
+std::vector<std::string> list_loose_objects() {
+    std::vector<std::string> object_hashes;
+    if (!fs::exists(config::OBJECTS_DIR)) { return object_hashes; }
+
+    for (const auto& dir : fs::directory_iterator(config::OBJECTS_DIR)) {
+        const std::string prefix = dir.path().filename().string();
+        if (!dir.is_directory() || prefix.size() != 2) { continue; }
+
+        for (const auto& file : fs::directory_iterator(dir.path())) {
+            const std::string object_hash = prefix + file.path().filename().string();
+            if (file.is_regular_file() && utils::is_valid_hash_syntax(object_hash)) { object_hashes.push_back(object_hash); }
+        }
+    }
+
+    std::sort(object_hashes.begin(), object_hashes.end());
+    return object_hashes;
+}
+
+int ReachabilityIndex::find_position(const std::string& object_hash) const {
+    auto it = std::lower_bound(object_hashes.begin(), object_hashes.end(), object_hash);
+    return (it != object_hashes.end() && *it == object_hash) ? int(it - object_hashes.begin()) : -1;
+}
+
+void ReachabilityIndex::load() {
+    object_hashes.clear();
+    bitmaps.clear();
+    if (!utils::is_file_exist(config::BITMAP_FILE)) { return; }
+
+    const std::string content = utils::read_file_content(config::BITMAP_FILE);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(content.data());
+
+    try {
+        if (content.size() < HEADER_SIZE || std::memcmp(data, BITMAP_SIGNATURE, 4) != 0 || utils::read_u32(data + 4) != BITMAP_VERSION) {
+            throw std::runtime_error("Unknown bitmap file");
+        }
+
+        const uint32_t object_count = utils::read_u32(data + 8);
+        const uint32_t bitmap_count = utils::read_u32(data + 12);
+        std::size_t offset = HEADER_SIZE;
+
+        if (content.size() < offset + std::size_t(object_count) * ID_SIZE) { throw std::runtime_error("Truncated bitmap file"); }
+        for (uint32_t i = 0; i < object_count; i++, offset += ID_SIZE) { object_hashes.push_back(utils::raw_to_hash(data + offset)); }
+
+        const std::size_t word_count = (object_hashes.size() + 63) / 64;
+        for (uint32_t i = 0; i < bitmap_count; i++) {
+            if (content.size() < offset + 8) { throw std::runtime_error("Truncated bitmap file"); }
+            const uint32_t position = utils::read_u32(data + offset);
+            const uint32_t compressed_count = utils::read_u32(data + offset + 4);
+            offset += 8;
+
+            if (position >= object_count || content.size() < offset + std::size_t(compressed_count) * 8) { throw std::runtime_error("Truncated bitmap file"); }
+
+            std::vector<uint64_t> compressed(compressed_count);
+            for (uint32_t j = 0; j < compressed_count; j++, offset += 8) { compressed[j] = utils::read_u64(data + offset); }
+
+            bitmaps[object_hashes[position]] = ewah::decompress(compressed, word_count);
+        }
+    }
+    catch (const std::runtime_error&) {
+        // Only an optimization, walks fall back to reading every object
+        object_hashes.clear();
+        bitmaps.clear();
+    }
+}
+
+void ReachabilityIndex::write() const {
+    std::vector<unsigned char> buffer(HEADER_SIZE + object_hashes.size() * ID_SIZE);
+    std::memcpy(buffer.data(), BITMAP_SIGNATURE, 4);
+    utils::write_u32(buffer.data() + 4, BITMAP_VERSION);
+    utils::write_u32(buffer.data() + 8, object_hashes.size());
+    utils::write_u32(buffer.data() + 12, bitmaps.size());
+
+    for (std::size_t i = 0; i < object_hashes.size(); i++) {
+        std::memcpy(buffer.data() + HEADER_SIZE + i * ID_SIZE, utils::hash_to_raw(object_hashes[i]).data(), ID_SIZE);
+    }
+
+    for (const auto& [commit_hash, bits] : bitmaps) {
+        const std::vector<uint64_t> compressed = ewah::compress(bits);
+
+        std::size_t offset = buffer.size();
+        buffer.resize(offset + 8 + compressed.size() * 8);
+        utils::write_u32(buffer.data() + offset, find_position(commit_hash));
+        utils::write_u32(buffer.data() + offset + 4, compressed.size());
+        offset += 8;
+
+        for (const uint64_t word : compressed) { utils::write_u64(buffer.data() + offset, word); offset += 8; }
+    }
+
+    // Written aside and renamed over, a reader never sees half a file
+    const std::string bitmap_path = utils::resolve_symlink(config::BITMAP_FILE);
+    const std::string lock_path = bitmap_path + ".lock";
+    std::ofstream out(lock_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        const std::string error_msg = "Failed to open file: " + lock_path;
+        throw std::runtime_error(error_msg);
+    }
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    out.close();
+
+    fs::rename(lock_path, bitmap_path);
+}
+
+bool ReachabilityIndex::contains(const std::vector<uint64_t>& bits, const std::string& object_hash) const {
+    const int position = find_position(object_hash);
+    return position >= 0 && (bits[position / 64] >> (position % 64)) & 1;
+}
+
+void ReachabilityIndex::get_reachable(const std::vector<std::string>& commit_hashes, const std::vector<std::string>& root_object_hashes, std::vector<uint64_t>& bits, std::unordered_set<std::string>& other_hashes) const {
+    bits.assign((object_hashes.size() + 63) / 64, 0);
+
+    // True the first time an object is seen
+    auto mark = [&](const std::string& object_hash) {
+        const int position = find_position(object_hash);
+        if (position < 0) { return other_hashes.insert(object_hash).second; }
+
+        uint64_t& word = bits[position / 64];
+        const uint64_t mask = 1ull << (position % 64);
+        if (word & mask) { return false; }
+        word |= mask;
+        return true;
+    };
+
+    // A tree seen before was walked completely, or came from a bitmap with everything under it
+    auto mark_tree = [&](const std::string& tree_hash) {
+        std::vector<std::string> trees = {tree_hash};
+        while (!trees.empty()) {
+            const std::string cur_tree_hash = trees.back();
+            trees.pop_back();
+            if (!mark(cur_tree_hash)) { continue; }
+
+            for (const TreeEntry& entry : utils::read_tree(cur_tree_hash)) {
+                if (entry.type == "tree") { trees.push_back(entry.hash); }
+                else { mark(entry.hash); }
+            }
+        }
+    };
+
+    for (const std::string& object_hash : root_object_hashes) { mark(object_hash); }
+
+    CommitGraph graph;
+    std::vector<std::string> stack = commit_hashes;
+
+    while (!stack.empty()) {
+        const std::string commit_hash = stack.back();
+        stack.pop_back();
+        if (!mark(commit_hash)) { continue; }
+
+        auto it = bitmaps.find(commit_hash);
+        if (it != bitmaps.end()) {
+            for (std::size_t i = 0; i < bits.size(); i++) { bits[i] |= it->second[i]; }
+            continue;
+        }
+
+        const CommitNode& node = graph.get_commit(commit_hash);
+        mark_tree(node.tree_hash);
+        for (const std::string& parent_hash : node.parents) { stack.push_back(parent_hash); }
+    }
+}
+
+void ReachabilityIndex::build(const std::vector<std::string>& new_object_hashes, const std::vector<std::string>& commit_hashes) {
+    object_hashes = new_object_hashes;
+    std::sort(object_hashes.begin(), object_hashes.end());
+    object_hashes.erase(std::unique(object_hashes.begin(), object_hashes.end()), object_hashes.end());
+    bitmaps.clear();
+
+    CommitGraph graph;
+    std::vector<std::string> sorted_hashes = commit_hashes;
+    std::sort(sorted_hashes.begin(), sorted_hashes.end(), [&](const std::string& a, const std::string& b) {
+        return std::make_pair(graph.get_generation(a), a) < std::make_pair(graph.get_generation(b), b);
+    });
+    sorted_hashes.erase(std::unique(sorted_hashes.begin(), sorted_hashes.end()), sorted_hashes.end());
+
+    for (const std::string& commit_hash : sorted_hashes) {
+        if (find_position(commit_hash) < 0) { continue; }
+
+        std::vector<uint64_t> bits;
+        std::unordered_set<std::string> other_hashes;
+        get_reachable({commit_hash}, {}, bits, other_hashes);
+
+        // An object missing from the table would silently drop out of every walk using this bitmap
+        if (other_hashes.empty()) { bitmaps[commit_hash] = std::move(bits); }
+    }
+}
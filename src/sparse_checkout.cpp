@@ -0,0 +1,149 @@
+#include "sparse_checkout.hpp"
+#include "utils.hpp"
+#include "config.hpp"
+
+SparseCheckout::SparseCheckout() {
+    if (!utils::is_file_exist(config::SPARSE_CHECKOUT_FILE)) { return; }
+
+    std::vector<std::string> dirs;
+    std::ifstream in(config::SPARSE_CHECKOUT_FILE);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] != '#') { dirs.push_back(line); }
+    }
+
+    *this = SparseCheckout(dirs);
+    is_sparse_index = utils::is_file_exist(config::SPARSE_INDEX_FILE);
+}
+
+SparseCheckout::SparseCheckout(const std::vector<std::string>& dirs, bool enable) : is_enabled(enable) {
+    if (!is_enabled) { return; }
+
+    parent_dirs.insert("");
+
+    for (std::string dir : dirs) {
+        while (!dir.empty() && dir.back() == '/') { dir.pop_back(); }
+        if (dir.empty()) { continue; }
+
+        cone_dirs.insert(dir);
+        for (size_t pos = dir.find('/'); pos != std::string::npos; pos = dir.find('/', pos + 1)) {
+            parent_dirs.insert(dir.substr(0, pos));
+        }
+    }
+}
+
+void SparseCheckout::save() const {
+    if (!is_sparse_index) { fs::remove(config::SPARSE_INDEX_FILE); }
+
+    if (!is_enabled) {
+        fs::remove(config::SPARSE_CHECKOUT_FILE);
+        return;
+    }
+
+    fs::create_directories(fs::path(config::SPARSE_CHECKOUT_FILE).parent_path());
+
+    std::ofstream out(config::SPARSE_CHECKOUT_FILE, std::ios::trunc);
+    if (!out) {
+        const std::string error_msg = "Failed to open file: " + config::SPARSE_CHECKOUT_FILE;
+        throw std::runtime_error(error_msg);
+    }
+    for (const std::string& dir : cone_dirs) { out << dir << "\n"; }
+
+    if (is_sparse_index && utils::create_file(config::SPARSE_INDEX_FILE, "") == utils::FILE_STATUS::ERROR) {
+        const std::string error_msg = "Failed to create file: " + config::SPARSE_INDEX_FILE;
+        throw std::runtime_error(error_msg);
+    }
+}
+
+bool SparseCheckout::is_under_cone(const std::string& dirpath) const {
+    for (size_t pos = dirpath.find('/'); pos != std::string::npos; pos = dirpath.find('/', pos + 1)) {
+        if (cone_dirs.count(dirpath.substr(0, pos))) { return true; }
+    }
+    return cone_dirs.count(dirpath) > 0;
+}
+
+bool SparseCheckout::is_skip_worktree(const std::string& filepath) const {
+    if (!is_enabled) { return false; }
+
+    const size_t slash_pos = filepath.rfind('/');
+    const std::string dirpath = (slash_pos == std::string::npos) ? "" : filepath.substr(0, slash_pos);
+    return !parent_dirs.count(dirpath) && !is_under_cone(dirpath);
+}
+
+bool SparseCheckout::is_outside(const std::string& dirpath) const {
+    return is_enabled && !parent_dirs.count(dirpath) && !is_under_cone(dirpath);
+}
+
+void SparseCheckout::collapse_index(std::map<std::string, IndexEntry>& index_entries, const std::string& tree_hash) const {
+    if (!is_sparse_index || tree_hash.empty()) { return; }
+    collapse_tree(index_entries, tree_hash, "");
+}
+
+// Only the parent directories of the cones are walked, the directories outside hang off them
+void SparseCheckout::collapse_tree(std::map<std::string, IndexEntry>& index_entries, const std::string& tree_hash, const std::string& path) const {
+    for (const TreeEntry& tree_entry : utils::read_tree(tree_hash)) {
+        if (tree_entry.type != "tree") { continue; }
+
+        const std::string dirpath = path + tree_entry.name;
+        if (is_under_cone(dirpath)) { continue; }
+        if (!is_outside(dirpath)) {
+            collapse_tree(index_entries, tree_entry.hash, dirpath + "/");
+            continue;
+        }
+
+        // "dir/" sorts before every path under the directory, the entries are one range
+        const std::string prefix = dirpath + "/";
+        auto first = index_entries.lower_bound(prefix);
+        auto last = first;
+        while (last != index_entries.end() && last->first.compare(0, prefix.size(), prefix) == 0) { ++last; }
+
+        if (first == last) { continue; }
+        if (std::next(first) == last && first->first == prefix && first->second.hash == tree_entry.hash) { continue; }
+
+        std::map<std::string, IndexEntry> dir_entries(first, last);
+        expand_index(dir_entries);
+
+        std::stringstream buffer;
+        utils::solve(tree_entry.hash, buffer, prefix);
+
+        std::size_t file_count = 0;
+        bool is_same = true;
+        std::string line;
+        while (is_same && std::getline(buffer, line)) {
+            std::istringstream line_stream(line);
+            std::string filepath, hash, size, mode;
+            line_stream >> filepath >> hash >> size >> mode;
+
+            auto it = dir_entries.find(filepath);
+            is_same = (it != dir_entries.end() && it->second.hash == hash && it->second.mode == mode);
+            ++file_count;
+        }
+        if (!is_same || file_count != dir_entries.size()) { continue; } // staged changes keep the directory expanded
+
+        index_entries.erase(first, last);
+        index_entries[prefix] = IndexEntry(prefix, tree_entry.hash, tree_entry.size, "040000", tree_entry.mtime);
+    }
+}
+
+void SparseCheckout::expand_index(std::map<std::string, IndexEntry>& index_entries) {
+    std::vector<IndexEntry> dir_entries;
+    for (const auto& [path, entry] : index_entries) {
+        if (is_sparse_dir(entry)) { dir_entries.push_back(entry); }
+    }
+
+    for (const IndexEntry& dir_entry : dir_entries) {
+        index_entries.erase(dir_entry.filepath);
+
+        std::stringstream buffer;
+        utils::solve(dir_entry.hash, buffer, dir_entry.filepath); // sizes and mtimes as the tree records them
+
+        std::string line;
+        while (std::getline(buffer, line)) {
+            std::istringstream line_stream(line);
+            IndexEntry entry;
+            if (line_stream >> entry.filepath >> entry.hash >> entry.size >> entry.mode >> entry.mtime) {
+                index_entries.emplace(entry.filepath, entry);
+            }
+        }
+    }
+}
@@ -1,4 +1,15 @@
 #include "utils.hpp"
+#include "commit_graph.hpp"
+#include "diff_engine.hpp"
+#include "thread_pool.hpp"
+#include "object_stream.hpp"
+#include "sparse_checkout.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <memory>
 
 namespace utils {
 
@@ -18,6 +29,11 @@ namespace utils {
         return fs::exists(path) && fs::is_regular_file(path);
     }
 
+    std::string resolve_symlink(const std::string& path) {
+        if (!fs::is_symlink(path)) { return path; }
+        return (fs::path(path).parent_path() / fs::read_symlink(path)).lexically_normal().string();
+    }
+
     DIR_STATUS create_directory(const std::string& path) {
         if (is_directory_exist(path)) {
             return DIR_STATUS::ALREADY_EXIST;
@@ -115,13 +131,85 @@ namespace utils {
         }
     }
 
+    namespace {
+        // Published once read and swapped on reload. Lookups only load the pointer, a replaced list is kept alive
+        // because references to it may still be in use.
+        std::atomic<const std::vector<std::string>*> alternate_dirs{nullptr};
+        std::vector<std::unique_ptr<const std::vector<std::string>>> retired_alternate_dirs;
+
+        std::vector<std::string> read_alternate_dirs() {
+            std::vector<std::string> dirs;
+            std::set<std::string> seen;
+
+            // {object dir, depth}, one absolute path per line; a relative one is relative to the listing object dir
+            std::vector<std::pair<fs::path, int>> stack = {{fs::absolute(config::OBJECTS_DIR), 0}};
+            while (!stack.empty()) {
+                const auto [objects_dir, depth] = stack.back();
+                stack.pop_back();
+                if (depth >= config::ALTERNATES_MAX_DEPTH) { continue; }
+
+                std::ifstream alternates_file(objects_dir / "info" / "alternates");
+                std::string line;
+                while (std::getline(alternates_file, line)) {
+                    if (line.empty() || line[0] == '#') { continue; }
+
+                    const fs::path alternate_dir = fs::weakly_canonical(objects_dir / line);
+                    if (!fs::is_directory(alternate_dir) || !seen.insert(alternate_dir.string()).second) { continue; }
+
+                    dirs.push_back(alternate_dir.string() + "/");
+                    stack.push_back({alternate_dir, depth + 1});
+                }
+            }
+
+            return dirs;
+        }
+    }
+
+    const std::vector<std::string>& get_alternate_dirs() {
+        // Every object lookup goes through here, the files are read the first time only
+        const std::vector<std::string>* dirs = alternate_dirs.load(std::memory_order_acquire);
+        if (dirs != nullptr) { return *dirs; }
+
+        // Threads racing on the first read each read the files, one list wins
+        auto read_dirs = std::make_unique<const std::vector<std::string>>(read_alternate_dirs());
+        if (alternate_dirs.compare_exchange_strong(dirs, read_dirs.get(), std::memory_order_acq_rel)) { return *read_dirs.release(); }
+        return *dirs;
+    }
+
+    void reload_alternate_dirs() {
+        auto read_dirs = std::make_unique<const std::vector<std::string>>(read_alternate_dirs());
+        const std::vector<std::string>* prev_dirs = alternate_dirs.exchange(read_dirs.release(), std::memory_order_acq_rel);
+        if (prev_dirs != nullptr) { retired_alternate_dirs.emplace_back(prev_dirs); }
+    }
+
+    RepositoryScope::RepositoryScope(const fs::path& path) : prev_path(fs::current_path()) {
+        fs::current_path(path);
+        reload_alternate_dirs();
+    }
+
+    RepositoryScope::~RepositoryScope() {
+        std::error_code ec;
+        fs::current_path(this->prev_path, ec);
+        try { reload_alternate_dirs(); }
+        catch (const std::exception&) {}
+    }
+
     std::string get_object_path(const std::string& obj_hash) {
         if(!is_valid_hash_syntax(obj_hash)) {
             const std::string error_msg = "Invalid object hash: " + obj_hash;
             throw std::invalid_argument(error_msg);
         }
 
-        return config::OBJECTS_DIR + obj_hash.substr(0, 2) + "/" + obj_hash.substr(2);
+        const std::string relative_path = obj_hash.substr(0, 2) + "/" + obj_hash.substr(2);
+        const std::string obj_path = config::OBJECTS_DIR + relative_path;
+
+        const std::vector<std::string>& alternate_dirs = get_alternate_dirs();
+        if (alternate_dirs.empty() || is_file_exist(obj_path)) { return obj_path; }
+
+        for (const std::string& alternate_dir : alternate_dirs) {
+            if (is_file_exist(alternate_dir + relative_path)) { return alternate_dir + relative_path; }
+        }
+        return obj_path; // written here when it's created
     }
 
     bool is_exist_obj(const std::string& obj_hash) {
@@ -381,6 +469,29 @@ namespace utils {
         return utils::extract_ref_branch(head_file_content);
     }
 
+    std::vector<std::string> get_worktree_paths() {
+        // objects/ of a linked worktree is a symlink into the main one
+        std::vector<std::string> worktree_paths = {fs::canonical(config::OBJECTS_DIR).parent_path().parent_path().string()};
+        if (!is_directory_exist(config::WORKTREES_DIR)) { return worktree_paths; }
+
+        // .vcs/worktrees/<name> holds the path of the worktree
+        for (const auto& entry : fs::directory_iterator(config::WORKTREES_DIR)) {
+            const std::string worktree_path = read_file_content(entry.path().string());
+            if (is_file_exist(worktree_path + "/" + config::HEAD_FILE)) { worktree_paths.push_back(worktree_path); }
+        }
+        std::sort(worktree_paths.begin() + 1, worktree_paths.end());
+
+        return worktree_paths;
+    }
+
+    std::string find_branch_worktree(const std::string& branch) {
+        for (const std::string& worktree_path : get_worktree_paths()) {
+            const std::string head_content = read_file_content(worktree_path + "/" + config::HEAD_FILE);
+            if (head_content.find("ref: ") != std::string::npos && extract_ref_branch(head_content) == branch) { return worktree_path; }
+        }
+        return "";
+    }
+
     std::string get_commit_hash(const std::string& branch_name) {
         const std::string branch_path = config::REFS_HEAD_DIR + branch_name;
         return utils::read_file_content(branch_path);
@@ -436,6 +547,9 @@ namespace utils {
     std::string get_tree_hash_from_commit(const std::string& commit_hash) {
         if(commit_hash == std::string(40, '0')) { return ""; }
 
+        CommitNode node;
+        if(CommitGraphFile::get_shared().lookup(commit_hash, node)) { return node.tree_hash; }
+
         const std::string commit_file = utils::get_object_path(commit_hash);
         const std::string commit_content = utils::read_and_decompress(commit_file);
         
@@ -457,6 +571,25 @@ namespace utils {
         return commit_content.substr(hash_start, hash_end - hash_start);
     }
 
+    std::time_t get_commit_timestamp(const std::string& commit_hash) {
+        if(commit_hash == std::string(40, '0')) { return 0; }
+
+        CommitNode node;
+        if(CommitGraphFile::get_shared().lookup(commit_hash, node)) { return node.time; }
+
+        const std::string commit_content = utils::read_and_decompress(utils::get_object_path(commit_hash));
+
+        // committer <username> <timestamp>
+        size_t committer_pos = commit_content.find("\ncommitter ");
+        if (committer_pos == std::string::npos) { return 0; }
+
+        size_t line_end = commit_content.find('\n', committer_pos + 1);
+        if (line_end == std::string::npos) { line_end = commit_content.size(); }
+
+        size_t timestamp_start = commit_content.rfind(' ', line_end) + 1;
+        return std::stoll(commit_content.substr(timestamp_start, line_end - timestamp_start));
+    }
+
     std::vector<std::string> get_all_branches(const std::string& path) {
         std::vector<std::string> branches;
         for (const auto& entry : std::filesystem::directory_iterator(path)) {
@@ -515,27 +648,64 @@ namespace utils {
             fs::create_directories(path.parent_path());
         }
 
-        // Read blob content using hash
-        std::string blob_raw = utils::read_and_decompress(utils::get_object_path(hash));
-        // blob_raw is "blob <size>\0<content>"
-        size_t null_pos = blob_raw.find('\0');
-        if (null_pos == std::string::npos) {
-            const std::string error_msg = "Corrupted blob object: missing null separator";
+        ObjectStream blob(utils::get_object_path(hash));
+        if (blob.type() != "blob") {
+            const std::string error_msg = "Corrupted blob object: " + hash + " is a " + blob.type();
             throw std::runtime_error(error_msg);
         }
-        
-        std::string blob_content = blob_raw.substr(null_pos + 1);
+
+        // Content goes from inflate to the file through a buffer every thread keeps for the next file
+        thread_local std::vector<char> chunk(64 * 1024);
 
         try {
             if (mode == "120000") {
                 // Symlink: content is target path
-                fs::create_symlink(blob_content, path);
+                std::string target;
+                for (size_t count; (count = blob.read(chunk.data(), chunk.size())) > 0; ) { target.append(chunk.data(), count); }
+                fs::create_symlink(target, path);
             } 
             else {
                 // Write file
-                std::ofstream out(path, std::ios::binary);
-                out << blob_content;
-                out.close();
+                const int fd = ::open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (fd < 0) {
+                    const std::string error_msg = std::string("open failed: ") + std::strerror(errno);
+                    throw std::runtime_error(error_msg);
+                }
+
+                // Closes the file however the write ends, and removes it unless all of the blob made it in
+                struct OpenFile {
+                    int fd;
+                    const std::string& path;
+                    bool is_complete = false;
+                    ~OpenFile() {
+                        ::close(fd);
+                        if (!is_complete) { ::unlink(path.c_str()); }
+                    }
+                } file{fd, filepath};
+
+                // The size is known from the header, the filesystem can lay the file out in one go. Only a hint,
+                // filesystems that can't do it are written to all the same.
+                if (blob.size() > 0) { posix_fallocate(fd, 0, blob.size()); }
+
+                size_t written = 0;
+                for (size_t count; (count = blob.read(chunk.data(), chunk.size())) > 0; ) {
+                    for (size_t offset = 0; offset < count; ) {
+                        const ssize_t ret = ::write(fd, chunk.data() + offset, count - offset);
+                        if (ret < 0 && errno == EINTR) { continue; }
+                        if (ret < 0) {
+                            const std::string error_msg = std::string("write failed: ") + std::strerror(errno);
+                            throw std::runtime_error(error_msg);
+                        }
+                        offset += ret;
+                    }
+                    written += count;
+                }
+
+                if (written != blob.size()) {
+                    const std::string error_msg = "Corrupted blob object: " + hash + " has " + std::to_string(written) + " bytes, its header says " + std::to_string(blob.size());
+                    throw std::runtime_error(error_msg);
+                }
+                file.is_complete = true;
 
                 // Set file permissions
                 if (mode == "100755") {
@@ -577,6 +747,19 @@ namespace utils {
         }
     }
 
+    std::string get_blob_content(const std::string& hash) {
+        std::string full = utils::read_and_decompress(utils::get_object_path(hash));
+
+        // blob is "blob <size>\0<content>"
+        size_t pos = full.find('\0');
+        if (pos == std::string::npos) {
+            const std::string error_msg = "Corrupted blob object: missing null separator";
+            throw std::runtime_error(error_msg);
+        }
+
+        return full.substr(pos + 1);
+    }
+
     bool is_commit_exists_on_branch(const std::string& branch, const std::string& cur_commit_hash) {
         const std::string branch_path = config::LOG_REFS_HEAD_DIR + branch;
 
@@ -650,7 +833,7 @@ namespace utils {
             iss >> mode >> type >> hash >> mtime >> size >> file_name;
 
             if (type == "tree") {
-                solve(hash, buffer, file_name + "/"); // Recursive call for sub-trees
+                solve(hash, buffer, path + file_name + "/"); // Recursive call for sub-trees
             } else if (type == "blob") {
                 const std::string filepath = path + file_name;
                 buffer << filepath << " " << hash << " " << size << " " << mode << " " << mtime << "\n"; // add to index file
@@ -658,6 +841,129 @@ namespace utils {
         }
     }
 
+    std::vector<TreeEntry> read_tree(const std::string& tree_hash) {
+        const std::string tree_content = utils::read_and_decompress(utils::get_object_path(tree_hash));
+
+        std::vector<TreeEntry> entries;
+        std::istringstream ss(tree_content);
+        std::string line;
+        std::getline(ss, line); // Read the first line (tree 286)
+
+        while (std::getline(ss, line)) {
+            if (line.empty()) continue;
+
+            std::istringstream iss(line);
+            TreeEntry entry;
+            if (iss >> entry.mode >> entry.type >> entry.hash >> entry.mtime >> entry.size >> entry.name) {
+                entries.push_back(entry);
+            }
+        }
+
+        return entries;
+    }
+
+    std::string hash_to_raw(const std::string& hash) {
+        if (hash.size() != 2 * SHA_DIGEST_LENGTH) { return ""; }
+
+        std::string raw(SHA_DIGEST_LENGTH, '\0');
+        for (std::size_t i = 0; i < hash.size(); i++) {
+            const char c = hash[i];
+            int value;
+            if (c >= '0' && c <= '9') { value = c - '0'; }
+            else if (c >= 'a' && c <= 'f') { value = c - 'a' + 10; }
+            else { return ""; }
+            raw[i / 2] = char((unsigned char)raw[i / 2] | (value << ((i % 2) ? 0 : 4)));
+        }
+        return raw;
+    }
+
+    std::string raw_to_hash(const unsigned char* raw) {
+        static const char digits[] = "0123456789abcdef";
+        std::string hash(2 * SHA_DIGEST_LENGTH, '0');
+        for (int i = 0; i < SHA_DIGEST_LENGTH; i++) {
+            hash[2 * i] = digits[raw[i] >> 4];
+            hash[2 * i + 1] = digits[raw[i] & 15];
+        }
+        return hash;
+    }
+
+    uint32_t read_u32(const unsigned char* p) {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+
+    void write_u32(unsigned char* p, const uint32_t value) {
+        p[0] = value >> 24; p[1] = value >> 16; p[2] = value >> 8; p[3] = value;
+    }
+
+    uint64_t read_u64(const unsigned char* p) { return (uint64_t(read_u32(p)) << 32) | read_u32(p + 4); }
+
+    void write_u64(unsigned char* p, const uint64_t value) { write_u32(p, value >> 32); write_u32(p + 4, uint32_t(value)); }
+
+    bool find_tree_entry(const std::string& tree_hash, const std::string& path, TreeEntry& entry) {
+        std::string cur_tree_hash = tree_hash;
+        std::istringstream components(path);
+        std::string name;
+        bool is_found = false;
+
+        while (std::getline(components, name, '/')) {
+            if (name.empty()) continue;
+            if (is_found && entry.type != "tree") { return false; } // a file in the middle of the path
+
+            is_found = false;
+            for (const TreeEntry& cur_entry : utils::read_tree(cur_tree_hash)) {
+                if (cur_entry.name == name) { entry = cur_entry; is_found = true; break; }
+            }
+            if (!is_found) { return false; }
+
+            cur_tree_hash = entry.hash;
+        }
+
+        return is_found;
+    }
+
+    void read_index(std::map<std::string, IndexEntry>& index_entries, const std::string& index_path) {
+        const std::string index_content = utils::read_and_decompress(index_path);
+        std::istringstream index_stream(index_content);
+        std::string line;
+        while(std::getline(index_stream, line)) {
+            if(line.empty()) continue; // Skip empty lines
+            std::istringstream line_stream(line);
+            // <file-path> <sha1-hash> <size> <mode> <mtime>
+            IndexEntry entry;
+            if(line_stream >> entry.filepath >> entry.hash >> entry.size >> entry.mode >> entry.mtime) {
+                index_entries[entry.filepath] = entry;
+            }
+        }
+    }
+
+    void write_index(const std::map<std::string, IndexEntry>& index_entries) {
+        std::ostringstream oss;
+        for (const auto& [filepath, entry] : index_entries) {
+            oss << filepath << " " << entry.hash << " " << entry.size << " " << entry.mode << " " << entry.mtime << "\n";
+        }
+
+        const std::string compressed_index_file = utils::compress_zlib(oss.str());
+
+        std::ofstream index_file(config::INDEX_FILE, std::ios::binary | std::ios::trunc);
+        if (!index_file) {
+            throw std::runtime_error("Failed to open file: " + config::INDEX_FILE);
+        }
+        index_file.write(compressed_index_file.data(), compressed_index_file.size());
+        index_file.close();
+    }
+
+    // Removes a tracked file and the directories it leaves empty
+    void remove_worktree_file(const std::string& filepath) {
+        fs::path path(filepath);
+        if (!fs::is_symlink(path) && !fs::exists(path)) { return; }
+
+        fs::remove(path);
+
+        for (fs::path dir = path.parent_path(); !dir.empty() && fs::is_directory(dir) && fs::is_empty(dir); dir = dir.parent_path()) {
+            fs::remove(dir);
+        }
+    }
+
     void clean_working_directory() {
         const fs::path cwd = fs::current_path();
         const std::set<std::string> ignore_list = utils::load_ignore_list();
@@ -687,6 +993,9 @@ namespace utils {
 
         // Tree tree;
 
+        const SparseCheckout sparse;
+        std::vector<std::pair<std::string, std::pair<std::string, std::string>>> files;
+
         std::istringstream iss(decompressed_data);
         std::string line;
         while (std::getline(iss, line)) {
@@ -694,8 +1003,145 @@ namespace utils {
             std::string filepath, hash, size, mode, mtime;
             line_stream >> filepath >> hash >> size >> mode >> mtime;
             
-            create_file_from_blob(filepath, hash, mode); // Create files based on the index
+            if (!sparse.is_skip_worktree(filepath)) { files.push_back({filepath, {mode, hash}}); } // Create files based on the index
         }
+
+        write_worktree_files(files);
+    }
+
+    std::vector<IndexEntry> write_worktree_files(const std::vector<std::pair<std::string, std::pair<std::string, std::string>>>& files) {
+        // Workers never race on creating the same parent directory
+        std::set<fs::path> dirs;
+        for (const auto& [filepath, file] : files) {
+            const fs::path dir = fs::path(filepath).parent_path();
+            if (!dir.empty()) { dirs.insert(dir); }
+        }
+        for (const fs::path& dir : dirs) { fs::create_directories(dir); }
+
+        std::vector<IndexEntry> index_entries(files.size());
+        if (files.empty()) { return index_entries; }
+
+        OrderedTaskPool<IndexEntry> pool(files.size());
+        pool.run(
+            [&](size_t index) {
+                const auto& [filepath, file] = files[index];
+                create_file_from_blob(filepath, file.second, file.first);
+
+                // A symlink's target may not exist, its own length and the time it was made stand in for the stat data
+                const bool is_symlink = (file.first == "120000");
+                const std::string size = std::to_string(is_symlink ? fs::read_symlink(filepath).string().size() : get_file_size(filepath));
+                const std::time_t mtime = is_symlink ? get_current_timestamp() : get_mtime(filepath);
+                return IndexEntry(filepath, file.second, size, file.first, mtime);
+            },
+            [&](size_t index, IndexEntry& entry) { index_entries[index] = std::move(entry); });
+
+        return index_entries;
+    }
+
+    std::string get_head_tree_hash() {
+        const std::string head_commit_hash = get_head_commit_hash();
+        if (head_commit_hash.empty() || head_commit_hash == std::string(40, '0')) { return ""; }
+        return get_tree_hash_from_commit(head_commit_hash);
+    }
+
+    bool refresh_index_entry(IndexEntry& entry) {
+        std::error_code ec;
+        const fs::file_status status = fs::symlink_status(entry.filepath, ec);
+        if (ec || !fs::exists(status) || fs::is_directory(status)) { return false; }
+
+        if (fs::is_symlink(status)) {
+            return entry.mode == "120000" && sha1(fs::read_symlink(entry.filepath).string()) == entry.hash;
+        }
+        if (get_file_mode(entry.filepath) != entry.mode) { return false; }
+
+        const std::string size = std::to_string(get_file_size(entry.filepath));
+        const std::time_t mtime = get_mtime(entry.filepath);
+        if (size == entry.size && mtime == entry.mtime) { return true; }
+
+        if (sha1(read_file_content(entry.filepath)) != entry.hash) { return false; }
+
+        entry.size = size;
+        entry.mtime = mtime;
+        return true;
+    }
+
+    void checkout_tree(const std::string& old_tree_hash, const std::string& new_tree_hash) {
+        const SparseCheckout sparse;
+        std::map<std::string, IndexEntry> index_entries;
+        if (is_file_exist(config::INDEX_FILE)) { read_index(index_entries); }
+        SparseCheckout::expand_index(index_entries); // directories outside of the cones are collapsed again at the end
+
+        // {path, {mode, blob_hash}} of the new tree for every path to bring over, an empty pair deletes the path
+        std::map<std::string, std::pair<std::string, std::string>> targets;
+        for (const FileChange& change : diff_engine::diff_trees(old_tree_hash, new_tree_hash)) {
+            targets[change.filepath] = change.new_file;
+        }
+
+        // Outside of 'targets' the new tree has what HEAD has, anything else in the index or on disk is reverted
+        std::map<std::string, std::pair<std::string, std::string>> head_files;
+        for (const FileChange& change : diff_engine::diff_trees("", old_tree_hash)) {
+            if (!targets.count(change.filepath)) { head_files[change.filepath] = change.new_file; }
+        }
+
+        for (auto& [filepath, entry] : index_entries) {
+            if (targets.count(filepath)) { continue; }
+
+            auto it = head_files.find(filepath);
+            if (it == head_files.end()) { targets[filepath] = {}; }     // staged new file
+            else if (it->second != std::make_pair(entry.mode, entry.hash) || (!sparse.is_skip_worktree(filepath) && !refresh_index_entry(entry))) { targets[filepath] = it->second; }
+        }
+        for (const auto& [filepath, file] : head_files) {
+            if (!index_entries.count(filepath)) { targets[filepath] = file; }  // staged deletion
+        }
+
+        // Deletions go first so a file can take the place of a directory
+        for (const auto& [filepath, file] : targets) {
+            if (!file.second.empty()) { continue; }
+            if (!sparse.is_skip_worktree(filepath)) { remove_worktree_file(filepath); }
+            index_entries.erase(filepath);
+        }
+
+        // Skip-worktree files only get their index entry, with the size and mtime the tree records. Every directory
+        // is read once however many of its files changed.
+        std::map<std::string, std::map<std::string, TreeEntry>> dir_entries;
+        auto get_tree_entry = [&](const std::string& filepath) -> const TreeEntry& {
+            const size_t slash_pos = filepath.rfind('/');
+            const std::string dirpath = (slash_pos == std::string::npos) ? "" : filepath.substr(0, slash_pos);
+
+            auto [it, is_new] = dir_entries.try_emplace(dirpath);
+            if (is_new) {
+                TreeEntry dir_entry;
+                dir_entry.hash = new_tree_hash;
+                if (!dirpath.empty()) { find_tree_entry(new_tree_hash, dirpath, dir_entry); }
+                for (const TreeEntry& entry : read_tree(dir_entry.hash)) { it->second[entry.name] = entry; }
+            }
+            return it->second.at(filepath.substr(slash_pos + 1));
+        };
+
+        std::vector<std::pair<std::string, std::pair<std::string, std::string>>> files;
+        for (const auto& [filepath, file] : targets) {
+            if (file.second.empty()) { continue; }
+
+            if (sparse.is_skip_worktree(filepath)) {
+                const TreeEntry& tree_entry = get_tree_entry(filepath);
+                index_entries[filepath] = IndexEntry(filepath, file.second, tree_entry.size, file.first, tree_entry.mtime);
+                continue;
+            }
+
+            // Untracked files and directories in the way are replaced, as a full checkout would have done
+            for (fs::path dir = fs::path(filepath).parent_path(); !dir.empty(); dir = dir.parent_path()) {
+                if (fs::is_symlink(dir) || (fs::exists(dir) && !fs::is_directory(dir))) { fs::remove(dir); }
+            }
+            if (fs::is_symlink(filepath) || file.first == "120000") { fs::remove(filepath); }
+            else if (fs::is_directory(filepath)) { fs::remove_all(filepath); }
+
+            files.push_back({filepath, file});
+        }
+
+        for (IndexEntry& entry : write_worktree_files(files)) { index_entries[entry.filepath] = std::move(entry); }
+
+        sparse.collapse_index(index_entries, new_tree_hash);
+        write_index(index_entries);
     }
 
     void get_lines_from_file(const std::string& path, std::vector<std::string>& lines) {
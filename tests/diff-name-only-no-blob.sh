@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+# diff --name-only between two commits lists paths from tree entries alone and never inflates a blob, even for a
+# rename with edits that --stat would pair by content.
+# usage: tests/diff-name-only-no-blob.sh [path-to-vcs]
+set -e
+
+VCS=$(realpath "${1:-test/main.out}")
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR"
+
+$VCS init >/dev/null
+seq 1 100 > a
+$VCS add . >/dev/null; $VCS commit one >/dev/null
+c1=$(cat .vcs/refs/heads/master)
+old_blob=$($VCS hash-object a | grep -o '[0-9a-f]\{40\}' | head -1)
+
+rm a; { seq 1 100; echo 101; } > b
+$VCS add . >/dev/null; $VCS commit two >/dev/null
+c2=$(cat .vcs/refs/heads/master)
+
+# The old blob can't be read any more, only its hash in the trees is left
+old_path=.vcs/objects/${old_blob:0:2}/${old_blob:2}
+chmod u+w "$old_path"
+echo garbage > "$old_path"
+
+if ! output=$($VCS diff --name-only "$c1" "$c2" 2>&1) || ! grep -q " a " <<< "$output" || ! grep -q " b " <<< "$output"; then
+    echo "FAIL: diff --name-only read a blob or missed a path"
+    echo "$output"
+    exit 1
+fi
+echo "PASS: diff-name-only-no-blob"
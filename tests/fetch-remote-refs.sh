@@ -0,0 +1,30 @@
+#!/usr/bin/env bash
+# fetch stores the branches of every source under its own name, and a clone that fails leaves no target behind.
+# usage: tests/fetch-remote-refs.sh [path-to-vcs]
+set -e
+
+VCS=$(realpath "${1:-test/main.out}")
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR"
+
+for repo in one two; do
+    mkdir "$repo"
+    (cd "$repo" && $VCS init >/dev/null && echo "$repo" > f && $VCS add . >/dev/null && $VCS commit "$repo" >/dev/null)
+done
+
+mkdir dst
+(cd dst && $VCS init >/dev/null && $VCS fetch ../one >/dev/null && $VCS fetch ../two >/dev/null)
+if [ ! -f dst/.vcs/refs/remotes/one/master ] || [ ! -f dst/.vcs/refs/remotes/two/master ] || cmp -s dst/.vcs/refs/remotes/one/master dst/.vcs/refs/remotes/two/master; then
+    echo "FAIL: the master branches of two sources don't each have their own remote ref"
+    exit 1
+fi
+
+# A detached HEAD on a commit the source doesn't have makes the clone fail half way
+printf '%040d' 0 | tr 0 a > one/.vcs/HEAD
+$VCS clone --no-hardlinks one copy >/dev/null 2>&1 || true
+if [ -e copy ]; then
+    echo "FAIL: a failed clone left its target directory behind"
+    exit 1
+fi
+echo "PASS: fetch-remote-refs"
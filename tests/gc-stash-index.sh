@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+# gc keeps the blobs a stash has staged: add a file, edit it, stash, gc --prune=now, then pop the stash and check the
+# staged blob is still there.
+# usage: tests/gc-stash-index.sh [path-to-vcs]
+set -e
+
+VCS=$(realpath "${1:-test/main.out}")
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR"
+
+$VCS init >/dev/null
+echo a > a.txt; $VCS add . >/dev/null; $VCS commit one >/dev/null
+echo staged > b.txt; $VCS add b.txt >/dev/null; echo unstaged > b.txt
+staged_hash=$(printf 'staged\n' | sha1sum | cut -d' ' -f1)
+
+$VCS stash -m w >/dev/null
+$VCS gc --prune=now >/dev/null
+$VCS stash pop 'stash{0}' >/dev/null
+
+if [ ! -f ".vcs/objects/${staged_hash:0:2}/${staged_hash:2}" ]; then
+    echo "FAIL: gc pruned the blob staged in the stash ($staged_hash)"
+    exit 1
+fi
+echo "PASS: gc-stash-index"
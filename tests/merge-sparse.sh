@@ -0,0 +1,40 @@
+#!/usr/bin/env bash
+# A merge inside a sparse checkout stages what the other branch changed outside of the cones without writing it to
+# the working directory, and with a sparse index the directory is a single entry again once the merge is committed.
+# usage: tests/merge-sparse.sh [path-to-vcs]
+set -e
+
+VCS=$(realpath "${1:-test/main.out}")
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR"
+
+$VCS init >/dev/null
+mkdir -p a b; echo x > a/x; echo y > b/y
+$VCS add . >/dev/null; $VCS commit one >/dev/null
+$VCS branch other >/dev/null
+
+echo Y | $VCS checkout other >/dev/null
+echo y2 > b/y
+$VCS add . >/dev/null; $VCS commit theirs >/dev/null
+
+echo Y | $VCS checkout master >/dev/null
+$VCS sparse-checkout set a --sparse-index >/dev/null
+echo x2 > a/x
+$VCS add . >/dev/null; $VCS commit ours >/dev/null
+
+$VCS merge other >/dev/null
+if [ -e b ]; then
+    echo "FAIL: the merge wrote b/, which is outside of the sparse checkout"
+    exit 1
+fi
+# The merge commit has the other branch's b/y, only a/x differs from it
+if $VCS diff --name-only other master | grep -q "b/y"; then
+    echo "FAIL: the merge commit lost the other branch's change to b/y"
+    exit 1
+fi
+if ! python3 -c "import zlib, sys; sys.stdout.write(zlib.decompress(open('.vcs/index', 'rb').read()).decode())" | grep -q "^b/ .* 040000 "; then
+    echo "FAIL: b/ isn't collapsed into one sparse index entry after the merge"
+    exit 1
+fi
+echo "PASS: merge-sparse"
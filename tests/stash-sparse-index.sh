@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+# stash and stash pop keep a sparse index consistent: out-of-cone directories stay single entries and status shows
+# no files under them as staged.
+# usage: tests/stash-sparse-index.sh [path-to-vcs]
+set -e
+
+VCS=$(realpath "${1:-test/main.out}")
+DIR=$(mktemp -d)
+trap 'rm -rf "$DIR"' EXIT
+cd "$DIR"
+
+$VCS init >/dev/null
+mkdir -p a b/c; echo x > a/x; echo y > b/y; echo z > b/c/z
+$VCS add . >/dev/null; $VCS commit one >/dev/null
+$VCS sparse-checkout set a --sparse-index >/dev/null
+
+echo x2 > a/x
+$VCS stash -m w >/dev/null
+$VCS stash pop 'stash{0}' >/dev/null
+
+if $VCS status | grep -q "b/"; then
+    echo "FAIL: files under the out-of-cone directory b/ show up in status after stash pop"
+    exit 1
+fi
+echo "PASS: stash-sparse-index"